@@ -86,6 +86,6 @@ int AgeTracker::getTotalPopulation () const {
 
 void AgeTracker::setMirrorState () {
   for (int i = 0; i < maxAge; ++i) {
-    mirror->people[i] = people[i]; 
+    getMirror()->people[i] = people[i]; 
   }
 }
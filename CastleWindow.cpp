@@ -8,11 +8,13 @@
 
 #include "graphics/BuildingGraphics.hh"
 #include "graphics/GeoGraphics.hh"
+#include "game/ActionLog.hh"
 #include "game/Hex.hh"
 #include "Logger.hh"
 #include "game/MilUnit.hh"
 #include "Object.hh"
 #include "graphics/PlayerGraphics.hh"
+#include "graphics/RenderStats.hh"
 #include "RiderGame.hh"
 #include "StaticInitialiser.hh"
 #include "graphics/ThreeDSprite.hh"
@@ -27,6 +29,8 @@ const int buttonSize = 32;
 map<MilUnitTemplate const* const, QIcon> CastleInterface::icons;
 
 WarfareWindow* WarfareWindow::currWindow = 0;
+const double GLDrawer::cullMargin = 0.5;
+const double GLDrawer::lodPixelError = 4;
 
 HexDrawer::HexDrawer (QWidget* p)
   : parent(p)
@@ -288,6 +292,7 @@ void TextInfoDisplay::draw () {
 GLDrawer::GLDrawer (QWidget* p)
   : HexDrawer(p)
   , QGLWidget(p)
+  , sceneFrozen(false)
   , cSprite(0)
   , tSprite(0)
   , farmSprite(0)
@@ -301,26 +306,21 @@ void GLDrawer::setTranslate (int x, int y) {
   translateY -= zoomLevel*(y*cos(radial) - x*sin(radial));
 }
 
-void GLDrawer::drawCastle (Castle* castle) const {
-  if (!castle) return;
-  CastleGraphicsInfo* cgi = castle->getGraphicsInfo();
-  if (!cgi) return;
-
-  triplet castlePos = cgi->getPosition();
+void GLDrawer::drawCastle (const CastleDraw& castle) const {
+  const triplet& castlePos = castle.position;
   vector<int> texts;
-  texts.push_back(castle->getOwner()->getGraphicsInfo()->getFlagTexture());
+  texts.push_back(castle.flag);
 
   glMatrixMode(GL_MODELVIEW);
   glPushMatrix();
   glTranslated(castlePos.x(), castlePos.y(), castlePos.z());
 
-  triplet normal = cgi->getNormal();
+  const triplet& normal = castle.normal;
   double angle = radToDeg(zaxis.angle(normal));
   triplet axis = zaxis.cross(normal);
   glRotated(angle, axis.x(), axis.y(), axis.z());
 
-  angle = cgi->getAngle();
-  glRotated(angle, 0, 0, 1);
+  glRotated(castle.angle, 0, 0, 1);
 
   //glBindTexture(GL_TEXTURE_2D, textureIDs[castleTextureIndices[3]]);
   cSprite->draw(texts);
@@ -335,66 +335,62 @@ void GLDrawer::drawCastle (Castle* castle) const {
 
 }
 
-void GLDrawer::drawLine (LineGraphicsInfo const* dat) {
-  glColor4d(1.0, 1.0, 1.0, 1.0);
-  glEnable(GL_TEXTURE_2D);
-
-  drawCastle(dat->getGameObject()->getCastle());
-  if (overlayMode) overlayMode->drawLine(dat);
-}
-
-void GLDrawer::drawSprites (const SpriteContainer* info, vector<int>& texts, double angle) {
+void GLDrawer::queueSprites (const SpriteContainer* info, triplet center, double angle, int flag) {
+  // Queues each figure at center + R(angle) * (formation + position), as
+  // the old rotate-then-translate matrix stack placed them.
+  double cosAngle = cos(degToRad(angle));
+  double sinAngle = sin(degToRad(angle));
   for (SpriteContainer::spriterator sprite = info->start(); sprite != info->final(); ++sprite) {
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glPushMatrix();
-    glRotated(angle, 0, 0, 1);
-    glTranslated(sprite.getFormation().x(), sprite.getFormation().y(), 0);
+    doublet formation = sprite.getFormation();
     for (vector<doublet>::iterator p = (*sprite)->positions.begin(); p != (*sprite)->positions.end(); ++p) {
-      glPushMatrix();
-      glTranslated((*p).x(), (*p).y(), 0);
-      (*sprite)->soldier->draw(texts);
-      glPopMatrix();
+      double x = formation.x() + (*p).x();
+      double y = formation.y() + (*p).y();
+      triplet position(center.x() + cosAngle * x - sinAngle * y, center.y() + sinAngle * x + cosAngle * y, center.z());
+      (*sprite)->soldier->addInstance(position, angle, flag);
     }
-    glPopMatrix();
   }
 }
+void GLDrawer::queueMilUnit (const SpriteContainer* unit, Player* player, triplet center, double angle, vector<UnitFlag>& flags) {
+  int flagTexture = player ? player->getGraphicsInfo()->getFlagTexture() : -1;
+  if (-1 != flagTexture) {
+    UnitFlag flag;
+    flag.position = triplet(center.x(), center.y(), center.z() - 0.7);
+    flag.texture = flagTexture;
+    flags.push_back(flag);
+  }
+  queueSprites(unit, center, angle, flagTexture);
+}
 
-void GLDrawer::drawMilUnit (const SpriteContainer* unit, Player* player, triplet center, double angle) {
-  vector<int> texts;
-  if (player) texts.push_back(player->getGraphicsInfo()->getFlagTexture());
-
-  glMatrixMode(GL_MODELVIEW);
-  glPushMatrix();
-  glTranslated(center.x(), center.y(), center.z());
-
-  glPushMatrix();
-  glTranslated(0, 0, -0.7);
-  glRotated(-radToDeg(radial), 0, 0, 1);
-  glBindTexture(GL_TEXTURE_2D, texts[0]);
+void GLDrawer::drawFlags (const vector<UnitFlag>& flags) {
+  // Turned to face the camera, as the old glRotated(-radial) did.
   double flagSize = 0.1*sqrt(zoomLevel);
-  glBegin(GL_QUADS);
-  glTexCoord2d(0, 0);
-  glVertex3d(0, 0, 0);
-  glTexCoord2d(1, 0);
-  glVertex3d(flagSize, 0, 0);
-  glTexCoord2d(1, 1);
-  glVertex3d(flagSize, 0, -flagSize);
-  glTexCoord2d(0, 1);
-  glVertex3d(0, 0, -flagSize);
-  glEnd();
-  glPopMatrix();
-
-  drawSprites(unit, texts, angle);
-  glPopMatrix();
+  double flagX = flagSize*cos(radial);
+  double flagY = -flagSize*sin(radial);
+  for (vector<UnitFlag>::const_iterator flag = flags.begin(); flag != flags.end(); ++flag) {
+    const triplet& pos = (*flag).position;
+    if (!frustum.sphereVisible(pos, flagSize + cullMargin)) continue;
+    glBindTexture(GL_TEXTURE_2D, (*flag).texture);
+    RenderStats::textureBinds++;
+    RenderStats::drawCalls++;
+    RenderStats::vertices += 4;
+    glBegin(GL_QUADS);
+    glTexCoord2d(0, 0);
+    glVertex3d(pos.x(), pos.y(), pos.z());
+    glTexCoord2d(1, 0);
+    glVertex3d(pos.x() + flagX, pos.y() + flagY, pos.z());
+    glTexCoord2d(1, 1);
+    glVertex3d(pos.x() + flagX, pos.y() + flagY, pos.z() - flagSize);
+    glTexCoord2d(0, 1);
+    glVertex3d(pos.x(), pos.y(), pos.z() - flagSize);
+    glEnd();
+  }
 }
 
-
-void GLDrawer::drawVertex (VertexGraphicsInfo const* gInfo) {
+void GLDrawer::queueVertex (VertexGraphicsInfo const* gInfo) {
   Vertex* dat = gInfo->getGameObject();
 
   MilUnit* unit = dat->getUnit(0);
   if (!unit) return;
-  glEnable(GL_TEXTURE_2D);
   triplet center = gInfo->getPosition();
 
   double angle = 0;
@@ -410,47 +406,87 @@ void GLDrawer::drawVertex (VertexGraphicsInfo const* gInfo) {
   case LeftUp    : angle =  60; break;
   }
 
-  drawMilUnit(unit->getGraphicsInfo(), unit->getOwner(), center, angle);
+  queueMilUnit(unit->getGraphicsInfo(), unit->getOwner(), center, angle, scene.unitFlags);
+}
+
+void GLDrawer::uploadZoneMesh (int which) {
+  ZoneMesh& mesh = zoneMeshes[which];
+  ZoneGraphicsInfo* zoneInfo = ZoneGraphicsInfo::getByIndex(which);
+  zoneInfo->fillMesh(mesh.vertices, mesh.indices, mesh.tiles);
+  mesh.numIndices = mesh.indices.size();
+  mesh.version = zoneInfo->getMeshVersion();
+  if (!getGLExtensionFunctions().openGL15Supported()) return;
+
+  if (0 == mesh.vertexBuffer) glGenBuffers(1, &mesh.vertexBuffer);
+  if (0 == mesh.indexBuffer) glGenBuffers(1, &mesh.indexBuffer);
+  glBindBuffer(GL_ARRAY_BUFFER, mesh.vertexBuffer);
+  glBufferData(GL_ARRAY_BUFFER, mesh.vertices.size() * sizeof(GLfloat), &mesh.vertices[0], GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBuffer);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(GLuint), &mesh.indices[0], GL_STATIC_DRAW);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  // The card has its own copy now.
+  vector<GLfloat>().swap(mesh.vertices);
+  vector<GLuint>().swap(mesh.indices);
+}
+
+int GLDrawer::pickLod (const ZoneGraphicsInfo::TerrainTile& tile, double cellSize) const {
+  // The frustum in paintGL is as wide as it is deep, so something of size
+  // s at distance d covers s/d of the screen width.
+  triplet center = (tile.low + tile.high) * 0.5;
+  double distance = (center - eyePosition).norm() - 0.5 * (tile.high - tile.low).norm();
+  if (distance <= 0) return 0;
+  double stepPixels = cellSize * width() / distance;
+  int lod = 0;
+  while ((lod + 1 < ZoneGraphicsInfo::numLods) && (stepPixels * (2 << lod) <= lodPixelError)) ++lod;
+  return lod;
 }
 
 void GLDrawer::drawZone (int which) {
   glColor4d(1.0, 1.0, 1.0, 1.0);
   glEnable(GL_TEXTURE_2D);
   glBindTexture(GL_TEXTURE_2D, zoneTextures[which]);
+  RenderStats::textureBinds++;
 
   ZoneGraphicsInfo* zoneInfo = ZoneGraphicsInfo::getByIndex(which);
-
-  static const double step = 1.0 / zoneSize;
-  glBegin(GL_TRIANGLES);
-
-  for (int x = 0; x < zoneSize - 1; ++x) {
-    for (int y = 0; y < zoneSize - 1; ++y) {
-      glTexCoord2d(x * step, y * step);
-      glVertex3d(zoneInfo->minX + x * step * zoneInfo->width, zoneInfo->minY + y * step * zoneInfo->height, zoneInfo->getHeight(x, y));
-
-      glTexCoord2d(x * step, (y+1) * step);
-      glVertex3d(zoneInfo->minX + x * step * zoneInfo->width, zoneInfo->minY + (y+1) * step * zoneInfo->height, zoneInfo->getHeight(x, (y+1)));
-
-      glTexCoord2d((x+1) * step, y * step);
-      glVertex3d(zoneInfo->minX + (x+1) * step * zoneInfo->width, zoneInfo->minY + y * step * zoneInfo->height, zoneInfo->getHeight((x+1), y));
-
-      //glNormal3d(1, 0, 1);
-      glTexCoord2d(x * step, (y+1) * step);
-      glVertex3d(zoneInfo->minX + x * step * zoneInfo->width, zoneInfo->minY + (y+1) * step * zoneInfo->height, zoneInfo->getHeight(x, (y+1)));
-
-
-      glTexCoord2d((x+1) * step, (y+1) * step);
-      glVertex3d(zoneInfo->minX + (x+1) * step * zoneInfo->width, zoneInfo->minY + (y+1) * step * zoneInfo->height, zoneInfo->getHeight((x+1), (y+1)));
-
-      glTexCoord2d((x+1) * step, y * step);
-      glVertex3d(zoneInfo->minX + (x+1) * step * zoneInfo->width, zoneInfo->minY + y * step * zoneInfo->height, zoneInfo->getHeight((x+1), y));
-    }
+  if ((int) zoneMeshes.size() <= which) zoneMeshes.resize(which + 1);
+  ZoneMesh& mesh = zoneMeshes[which];
+  if ((0 == mesh.numIndices) || (mesh.version != zoneInfo->getMeshVersion())) uploadZoneMesh(which);
+
+  static const GLsizei stride = 5 * sizeof(GLfloat);
+  const GLfloat* vertexBase = 0;
+  size_t indexBase = 0; // Byte offset into the index buffer, or address of the client-side array.
+  if (mesh.vertexBuffer) {
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.vertexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBuffer);
+  }
+  else {
+    vertexBase = &mesh.vertices[0];
+    indexBase = (size_t) &mesh.indices[0];
+  }
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+  glVertexPointer(3, GL_FLOAT, stride, vertexBase);
+  glTexCoordPointer(2, GL_FLOAT, stride, vertexBase + 3);
+  double cellSize = zoneInfo->cellSize();
+  for (vector<ZoneGraphicsInfo::TerrainTile>::const_iterator tile = mesh.tiles.begin(); tile != mesh.tiles.end(); ++tile) {
+    if (!frustum.boxVisible((*tile).low, (*tile).high)) continue;
+    int lod = pickLod(*tile, cellSize);
+    glDrawElements(GL_TRIANGLES, (*tile).numIndices[lod], GL_UNSIGNED_INT, (const GLvoid*) (indexBase + (*tile).firstIndex[lod] * sizeof(GLuint)));
+    RenderStats::drawCalls++;
+    RenderStats::vertices += (*tile).numIndices[lod];
+  }
+  glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+  if (mesh.vertexBuffer) {
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
   }
-
-  glEnd();
 
   glDisable(GL_TEXTURE_2D);
   for (ZoneGraphicsInfo::gridIt grid = zoneInfo->gridBegin(); grid != zoneInfo->gridEnd(); ++grid) {
+    RenderStats::drawCalls++;
+    RenderStats::vertices += (*grid).size();
     glBegin(GL_LINE_LOOP);
     for (ZoneGraphicsInfo::hexIt hex = (*grid).begin(); hex != (*grid).end(); ++hex) {
       glVertex3d((*hex).x(), (*hex).y(), (*hex).z());
@@ -459,43 +495,40 @@ void GLDrawer::drawZone (int which) {
   }
 }
 
-void GLDrawer::drawHex (HexGraphicsInfo const* dat,
-			FarmGraphicsInfo const* farmInfo,
-			VillageGraphicsInfo const* villageInfo,
-			MilUnitGraphicsInfo const* militiaInfo,
-			PlayerGraphicsInfo const* playerInfo) {
-  vector<int> texts; // Not used for trees.
-  glDisable(GL_TEXTURE_2D);
-  glMatrixMode(GL_MODELVIEW);
+void GLDrawer::queueHex (HexGraphicsInfo const* dat,
+			 FarmGraphicsInfo const* farmInfo,
+			 VillageGraphicsInfo const* villageInfo,
+			 MilUnitGraphicsInfo const* militiaInfo,
+			 PlayerGraphicsInfo const* playerInfo,
+			 ThreeDSprite::BatchList& fields) {
   for (GraphicsInfo::cpit tree = dat->startTrees(); tree != dat->finalTrees(); ++tree) {
-    glPushMatrix();
-    glTranslated((*tree).x(), (*tree).y(), (*tree).z());
-    tSprite->draw(texts);
-    glPopMatrix();
+    tSprite->addInstance(*tree);
   }
-  glColor4d(1.0, 1.0, 1.0, 1.0);
 
   if (!farmInfo) return;
-  glEnable(GL_TEXTURE_2D);
+  // Assume square fields, as two triangles sharing the first corner.
+  static const int fieldCorners[6] = {0, 1, 2, 0, 2, 3};
+  static const GLfloat fieldTexCoords[4][2] = {{0, 0}, {0, 1}, {1, 1}, {1, 0}};
   for (FarmGraphicsInfo::cfit field = farmInfo->start(); field != farmInfo->final(); ++field) {
-    glBindTexture(GL_TEXTURE_2D, (*field).getIndex());
-    glBegin(GL_POLYGON);
-    GraphicsInfo::cpit point = (*field).begin(); // Assume square fields, and unroll the loop.
-    glTexCoord2d(0, 0);
-    glVertex3d((*point).x(), (*point).y(), (*point).z()); ++point;
-    glTexCoord2d(0, 1);
-    glVertex3d((*point).x(), (*point).y(), (*point).z()); ++point;
-    glTexCoord2d(1, 1);
-    glVertex3d((*point).x(), (*point).y(), (*point).z()); ++point;
-    glTexCoord2d(1, 0);
-    glVertex3d((*point).x(), (*point).y(), (*point).z());
-    glEnd();
+    GLuint texture = (*field).getIndex();
+    ThreeDSprite::BatchList::iterator batch = fields.begin();
+    while ((batch != fields.end()) && ((*batch).texture != texture)) ++batch;
+    if (batch == fields.end()) {
+      fields.push_back(ThreeDSprite::Batch());
+      batch = fields.end() - 1;
+      (*batch).texture = texture;
+      (*batch).colour = triplet(1.0, 1.0, 1.0);
+    }
+    for (int i = 0; i < 6; ++i) {
+      const triplet& point = *((*field).begin() + fieldCorners[i]);
+      (*batch).corners.push_back(point.x());
+      (*batch).corners.push_back(point.y());
+      (*batch).corners.push_back(point.z());
+      (*batch).corners.push_back(fieldTexCoords[fieldCorners[i]][0]);
+      (*batch).corners.push_back(fieldTexCoords[fieldCorners[i]][1]);
+    }
   }
 
-  glMatrixMode(GL_MODELVIEW);
-  glEnable(GL_TEXTURE_2D);
-  glBindTexture(GL_TEXTURE_2D, 0);
-  texts.clear();
   int numHouses = villageInfo->getHouses();
   GraphicsInfo::cpit point1 = villageInfo->startHouse();
   GraphicsInfo::cpit point2 = villageInfo->startHouse(); ++point2;
@@ -509,20 +542,11 @@ void GLDrawer::drawHex (HexGraphicsInfo const* dat,
   double tranZ = ((*point2).z() - (*point1).z())*0.50;
 
   // Two rows of farmhouses.
-  glPushMatrix();
-  glTranslated((*point1).x() + tranX*0.5, (*point1).y() + tranY*0.5, (*point1).z() + tranZ*0.5);
+  triplet houseRow((*point1).x() + tranX*0.5, (*point1).y() + tranY*0.5, (*point1).z() + tranZ*0.5);
   for (int i = 0; i < numHouses; ++i) {
-    glPushMatrix();
-    glTranslated(xstep*(i/2) + tranX*(i%2), ystep*(i/2) + tranY*(i%2), zstep*(i/2) + tranZ*(i%2));
-    glRotated(180*(i%2), 0, 0, 1);
-    farmSprite->draw(texts);
-    glPopMatrix();
+    triplet house(houseRow.x() + xstep*(i/2) + tranX*(i%2), houseRow.y() + ystep*(i/2) + tranY*(i%2), houseRow.z() + zstep*(i/2) + tranZ*(i%2));
+    farmSprite->addInstance(house, 180*(i%2));
   }
-  glPopMatrix();
-
-  glBindTexture(GL_TEXTURE_2D, 0);
-  texts.clear();
-  if (playerInfo) texts.push_back(playerInfo->getFlagTexture());
 
   point1 = villageInfo->startDrill();
   point2 = villageInfo->startDrill(); ++point2;
@@ -537,13 +561,7 @@ void GLDrawer::drawHex (HexGraphicsInfo const* dat,
   if (pointer.x() < 0) angle = -90 - 60*sigDeltaY;
   else angle = 90 + 60*sigDeltaY;
 
-  glPushMatrix();
-  glTranslated(center.x(), center.y(), center.z());
-  drawSprites(militiaInfo, texts, angle);
-  glPopMatrix();
-
-  glBindTexture(GL_TEXTURE_2D, 0);
-  texts.clear();
+  queueSprites(militiaInfo, center, angle, playerInfo ? playerInfo->getFlagTexture() : -1);
 
   point1 = villageInfo->startSheep();
   point2 = villageInfo->startSheep(); ++point2;
@@ -556,11 +574,7 @@ void GLDrawer::drawHex (HexGraphicsInfo const* dat,
   if (pointer.x() > 0) angle = 90 + 60*sigDeltaY;
   else angle = -90 - 60*sigDeltaY;
 
-  glPushMatrix();
-  glTranslated(center.x(), center.y(), center.z());
-
-  drawSprites(villageInfo, texts, angle);
-  glPopMatrix();
+  queueSprites(villageInfo, center, angle, -1);
 }
 
 void SupplyMode::drawLine (LineGraphicsInfo const* lin) {
@@ -582,6 +596,8 @@ void SupplyMode::drawLine (LineGraphicsInfo const* lin) {
   glTranslated(pos.x(), pos.y(), pos.z());
   glRotated(angle, 0, 0, 1);
 
+  RenderStats::drawCalls++;
+  RenderStats::vertices += 8;
   glBegin(GL_POLYGON);
   glVertex3d(0.4, 0, -0.01);
   glVertex3d(0.1, 0.3, -0.01);
@@ -632,12 +648,8 @@ Hex* GLDrawer::findHex (double x, double y) {
   if (y > height()) return 0;
   convertToOGL(x, y);
 
-  for (HexGraphicsInfo::Iterator hex = HexGraphicsInfo::start(); hex != HexGraphicsInfo::final(); ++hex) {
-    if (!(*hex)->isInside(x, y)) continue;
-    return (*hex)->getGameObject();
-  }
-
-  return 0;
+  HexGraphicsInfo* hex = hexGrid.find(x, y);
+  return hex ? hex->getGameObject() : 0;
 }
 
 Line* GLDrawer::findLine (double x, double y) {
@@ -647,11 +659,8 @@ Line* GLDrawer::findLine (double x, double y) {
   if (y > height()) return 0;
   convertToOGL(x, y);
 
-  for (LineGraphicsInfo::Iterator lin = LineGraphicsInfo::start(); lin != LineGraphicsInfo::final(); ++lin) {
-    if (!((*lin)->isInside(x, y))) continue;
-    return (*lin)->getGameObject();
-  }
-  return 0;
+  LineGraphicsInfo* lin = lineGrid.find(x, y);
+  return lin ? lin->getGameObject() : 0;
 }
 
 Vertex* GLDrawer::findVertex (double x, double y) {
@@ -661,11 +670,8 @@ Vertex* GLDrawer::findVertex (double x, double y) {
   if (y > height()) return 0;
   convertToOGL(x, y);
 
-  for (VertexGraphicsInfo::Iterator vex = VertexGraphicsInfo::start(); vex != VertexGraphicsInfo::final(); ++vex) {
-    if (!((*vex)->isInside(x, y))) continue;
-    return (*vex)->getGameObject();
-  }
-  return 0;
+  VertexGraphicsInfo* vex = vertexGrid.find(x, y);
+  return vex ? vex->getGameObject() : 0;
 }
 
 int main (int argc, char** argv) {
@@ -682,19 +688,24 @@ int main (int argc, char** argv) {
   // Write debug log to file
   Logger::createStream(DebugStartup);
   FileLog debugfile("startDebugLog");
-  QObject::connect(&(Logger::logStream(DebugStartup)), SIGNAL(message(QString)), &debugfile, SLOT(message(QString)));
-
-  if (argc > 2) {
-    QObject::connect(&(Logger::logStream(Logger::Debug)),   SIGNAL(message(QString)), &debugfile, SLOT(message(QString)));
-    QObject::connect(&(Logger::logStream(Logger::Trace)),   SIGNAL(message(QString)), &debugfile, SLOT(message(QString)));
-    QObject::connect(&(Logger::logStream(Logger::Game)),    SIGNAL(message(QString)), &debugfile, SLOT(message(QString)));
-    QObject::connect(&(Logger::logStream(Logger::Warning)), SIGNAL(message(QString)), &debugfile, SLOT(message(QString)));
-    QObject::connect(&(Logger::logStream(Logger::Error)),   SIGNAL(message(QString)), &debugfile, SLOT(message(QString)));
+  Logger::logStream(DebugStartup).attach(&debugfile);
+
+  // Task 5 is the render benchmark, which needs the GL widget. Without a
+  // display, run it with QT_QPA_PLATFORM=offscreen (or under xvfb-run);
+  // LIBGL_ALWAYS_SOFTWARE=1 selects Mesa's software rasteriser.
+  bool benchmarkRendering = ((argc > 2) && (5 == atoi(argv[2])));
+  if ((argc > 2) && (!benchmarkRendering)) {
+    Logger::logStream(Logger::Debug).attach(&debugfile);
+    Logger::logStream(Logger::Trace).attach(&debugfile);
+    Logger::logStream(Logger::Game).attach(&debugfile);
+    Logger::logStream(Logger::Warning).attach(&debugfile);
+    Logger::logStream(Logger::Error).attach(&debugfile);
     for (int i = DebugGeneral; i < NumDebugs; ++i) {
-      QObject::connect(&(Logger::logStream(i)), SIGNAL(message(QString)), &debugfile, SLOT(message(QString)));
+      Logger::logStream(i).attach(&debugfile);
     }
     if (2 == atoi(argv[2])) WarfareGame::unitTests(argv[1]);
     else if (3 == atoi(argv[2])) WarfareGame::functionalTests(argv[1]);
+    else if ((4 == atoi(argv[2])) && (argc > 3)) WarfareGame::replayGame(argv[1], argv[3]);
     return 0;
   }
 
@@ -742,6 +753,10 @@ int main (int argc, char** argv) {
 
   window.show();
 
+  if (benchmarkRendering) {
+    window.renderBenchmark(argv[1], argc > 3 ? atoi(argv[3]) : 400);
+    return 0;
+  }
   if (argc > 2) window.chooseTask(argv[1], atoi(argv[2]));
   else if (argc > 1) window.newGame(argv[1]);
 
@@ -766,6 +781,9 @@ WarfareWindow::WarfareWindow (QWidget* parent)
   , selectedHex(0)
   , selectedLine(0)
   , selectedVertex(0)
+  , simulating(false)
+  , stopSimulation(false)
+  , simulationFinished(false)
   , plainMapModeButton(this)
   , supplyMapModeButton(this)
 {
@@ -813,6 +831,8 @@ WarfareWindow::WarfareWindow (QWidget* parent)
   plainMapModeButton.show();
 
   connect(&signalMapper, SIGNAL(mapped(int)), this, SLOT(setMapMode(int)));
+  connect(this, SIGNAL(simulationProgress(QString)), this, SLOT(showProgress(QString)), Qt::QueuedConnection);
+  connect(this, SIGNAL(simulationDone()), this, SLOT(nonHumansDone()), Qt::QueuedConnection);
 
   currentGame = 0;
   currWindow = this;
@@ -821,7 +841,9 @@ WarfareWindow::WarfareWindow (QWidget* parent)
   setFocus(Qt::OtherFocusReason);
 }
 
-WarfareWindow::~WarfareWindow () {}
+WarfareWindow::~WarfareWindow () {
+  stopNonHumans();
+}
 
 void WarfareWindow::chooseTask (string fname, int task) {
   switch (task) {
@@ -831,6 +853,16 @@ void WarfareWindow::chooseTask (string fname, int task) {
   }
 }
 
+// Loads the scenario as newGame does, without recording actions or
+// letting the AI move, and times GLDrawer::paintGL alone.
+void WarfareWindow::renderBenchmark (string fname, int frames) {
+  clearGame();
+  currentGame = WarfareGame::createGame(fname);
+  initialiseGraphics();
+  initialiseColours();
+  hexDrawer->benchmark(frames);
+}
+
 void WarfareWindow::newGame () {
   QString filename = QFileDialog::getOpenFileName(this, tr("Select file"), QString("./scenarios/"), QString("*.txt"));
   string fn = filename.toStdString();
@@ -841,6 +873,7 @@ void WarfareWindow::newGame () {
 void WarfareWindow::newGame (string fname) {
   clearGame();
   currentGame = WarfareGame::createGame(fname);
+  ActionLog::startRecording("actionlog.bin");
   initialiseGraphics();
   initialiseColours();
   runNonHumans();
@@ -855,6 +888,7 @@ void WarfareWindow::loadGame () {
 }
 
 void WarfareWindow::saveGame () {
+  if (simulating) return;
   QString filename = QFileDialog::getSaveFileName(this, tr("Select file"), QString("./savegames/"), QString("*.txt"));
   string fn = filename.toStdString();
   if (fn.empty()) return;
@@ -864,6 +898,7 @@ void WarfareWindow::saveGame () {
 
 void WarfareWindow::endTurn () {
   if (!currentGame) return;
+  if (simulating) return;
   if (!Player::getCurrentPlayer()->isHuman()) return;
   Action act;
   act.todo = Action::EndTurn;
@@ -941,13 +976,23 @@ void GLDrawer::paintGL () {
   glLoadIdentity();
 
   // We are looking down the z-axis, so positive z is into the screen
-  gluLookAt(0.01*translateX+zoomLevel*sin(azimuth)*sin(radial), // Notice x-y switch, to make North point upwards with radial=0
-	    0.01*translateY+zoomLevel*sin(azimuth)*cos(radial),
-	    -zoomLevel*cos(azimuth),
+  eyePosition = triplet(0.01*translateX+zoomLevel*sin(azimuth)*sin(radial), // Notice x-y switch, to make North point upwards with radial=0
+			0.01*translateY+zoomLevel*sin(azimuth)*cos(radial),
+			-zoomLevel*cos(azimuth));
+  gluLookAt(eyePosition.x(), eyePosition.y(), eyePosition.z(),
 	    0.01*translateX, 0.01*translateY, 0.0,
 	    -cos(azimuth)*sin(radial), -cos(azimuth)*cos(radial), -sin(azimuth));
 
+  GLdouble projection[16];
+  GLdouble modelview[16];
+  glGetDoublev(GL_PROJECTION_MATRIX, projection);
+  glGetDoublev(GL_MODELVIEW_MATRIX, modelview);
+  frustum.setMatrices(projection, modelview);
+  if ((!sceneFrozen) && (scene.version != GraphicsInfo::getSceneVersion())) rebuildScene();
+
   glColor4d(0.0, 0.0, 0.0, 0.5);
+  RenderStats::drawCalls++;
+  RenderStats::vertices += 4;
   glBegin(GL_QUADS);
 
   glVertex3d(-1000, -1000, 0.01);
@@ -959,34 +1004,250 @@ void GLDrawer::paintGL () {
   if (LineGraphicsInfo::start() != LineGraphicsInfo::final()) drawZone(0);
 
   glColor4d(1.0, 1.0, 1.0, 1.0);
-  for (LineGraphicsInfo::Iterator line = LineGraphicsInfo::start(); line != LineGraphicsInfo::final(); ++line) {
-    drawLine(*line);
+  glEnable(GL_TEXTURE_2D);
+  for (vector<CastleDraw>::const_iterator castle = scene.castles.begin(); castle != scene.castles.end(); ++castle) {
+    if (!frustum.sphereVisible((*castle).position, (*castle).radius + cullMargin)) continue;
+    drawCastle(*castle);
+  }
+  // The overlays read flows from the game, so they wait out a frozen scene.
+  if ((overlayMode) && (!sceneFrozen)) {
+    for (LineGraphicsInfo::Iterator line = LineGraphicsInfo::start(); line != LineGraphicsInfo::final(); ++line) {
+      if (!visible(*line)) continue;
+      overlayMode->drawLine(*line);
+    }
   }
 
-  for (Hex::Iterator hex = Hex::start(); hex != Hex::final(); ++hex) {
-    Farmland* farm = (*hex)->getFarm();
-    Village* village = (*hex)->getVillage();
-    MilUnit* militia = village ? village->getMilitia() : 0;
-    Player* owner = (*hex)->getOwner();
-    drawHex((*hex)->getGraphicsInfo(),
-	    farm ? farm->getGraphicsInfo() : 0,
-	    village ? village->getGraphicsInfo() : 0,
-	    militia ? militia->getGraphicsInfo() : 0,
-	    owner ? owner->getGraphicsInfo() : 0);
+  vector<const SceneBucket*> shown;
+  for (vector<SceneBucket>::const_iterator bucket = scene.buckets.begin(); bucket != scene.buckets.end(); ++bucket) {
+    if (frustum.boxVisible((*bucket).low, (*bucket).high)) shown.push_back(&(*bucket));
   }
 
+  glEnable(GL_TEXTURE_2D);
+  for (vector<const SceneBucket*>::iterator bucket = shown.begin(); bucket != shown.end(); ++bucket) ThreeDSprite::drawBatches((*bucket)->fields);
+  // Trees have always been drawn untextured.
+  glDisable(GL_TEXTURE_2D);
+  for (vector<const SceneBucket*>::iterator bucket = shown.begin(); bucket != shown.end(); ++bucket) ThreeDSprite::drawBatches((*bucket)->trees);
+  glEnable(GL_TEXTURE_2D);
+  for (vector<const SceneBucket*>::iterator bucket = shown.begin(); bucket != shown.end(); ++bucket) ThreeDSprite::drawBatches((*bucket)->villages);
+  glColor4d(1.0, 1.0, 1.0, 1.0);
+
   glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
-  for (VertexGraphicsInfo::Iterator vertex = VertexGraphicsInfo::start(); vertex != VertexGraphicsInfo::final(); ++vertex) {
-    drawVertex(*vertex);
-  }
+  drawFlags(scene.unitFlags);
+  for (vector<const SceneBucket*>::iterator bucket = shown.begin(); bucket != shown.end(); ++bucket) ThreeDSprite::drawBatches((*bucket)->units);
   glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
 
+  drawFlags(scene.transportFlags);
+  for (vector<const SceneBucket*>::iterator bucket = shown.begin(); bucket != shown.end(); ++bucket) ThreeDSprite::drawBatches((*bucket)->transports);
+}
+
+// Cells of an 8 by 8 grid over the hex centres, as the terrain is tiled.
+struct SceneGrid {
+  static const int perSide = 8;
+  static const int numCells = perSide * perSide;
+
+  SceneGrid (double x, double y) : minX(x), minY(y), maxX(x), maxY(y) {}
+  void include (const triplet& pos) {
+    minX = min(minX, pos.x());
+    minY = min(minY, pos.y());
+    maxX = max(maxX, pos.x());
+    maxY = max(maxY, pos.y());
+  }
+  int cell (const triplet& pos) const {
+    int col = (int) floor(perSide * (pos.x() - minX) / max(maxX - minX, 1e-6));
+    int row = (int) floor(perSide * (pos.y() - minY) / max(maxY - minY, 1e-6));
+    return min(perSide - 1, max(0, col)) + perSide * min(perSide - 1, max(0, row));
+  }
+
+  double minX;
+  double minY;
+  double maxX;
+  double maxY;
+};
+
+void GLDrawer::includeInBucket (SceneBucket& bucket, const GraphicsInfo* dat) {
+  triplet reach(dat->getRadius() + cullMargin, dat->getRadius() + cullMargin, dat->getRadius() + cullMargin);
+  triplet low = dat->getPosition() - reach;
+  triplet high = dat->getPosition() + reach;
+  bucket.low.x() = min(bucket.low.x(), low.x());
+  bucket.low.y() = min(bucket.low.y(), low.y());
+  bucket.low.z() = min(bucket.low.z(), low.z());
+  bucket.high.x() = max(bucket.high.x(), high.x());
+  bucket.high.y() = max(bucket.high.y(), high.y());
+  bucket.high.z() = max(bucket.high.z(), high.z());
+}
+
+void GLDrawer::SceneBucket::upload () {
+  ThreeDSprite::uploadBatches(fields);
+  ThreeDSprite::uploadBatches(trees);
+  ThreeDSprite::uploadBatches(villages);
+  ThreeDSprite::uploadBatches(units);
+  ThreeDSprite::uploadBatches(transports);
+}
+
+void GLDrawer::SceneBucket::release () {
+  ThreeDSprite::releaseBatches(fields);
+  ThreeDSprite::releaseBatches(trees);
+  ThreeDSprite::releaseBatches(villages);
+  ThreeDSprite::releaseBatches(units);
+  ThreeDSprite::releaseBatches(transports);
+}
+
+void GLDrawer::rebuildScene () {
+  for (vector<SceneBucket>::iterator bucket = scene.buckets.begin(); bucket != scene.buckets.end(); ++bucket) (*bucket).release();
+  scene.buckets.clear();
+  scene.unitFlags.clear();
+  scene.transportFlags.clear();
+  scene.castles.clear();
+
+  // Hexes, unit positions and transports are sorted into SceneGrid cells,
+  // and each cell is batched on its own so it can be culled as a whole.
+  if (Hex::start() == Hex::final()) {
+    scene.version = GraphicsInfo::getSceneVersion();
+    return;
+  }
+  triplet first = (*Hex::start())->getGraphicsInfo()->getPosition();
+  SceneGrid grid(first.x(), first.y());
+  for (Hex::Iterator hex = Hex::start(); hex != Hex::final(); ++hex) grid.include((*hex)->getGraphicsInfo()->getPosition());
+
+  vector<vector<Hex*> > hexes(SceneGrid::numCells);
+  vector<vector<VertexGraphicsInfo*> > vertices(SceneGrid::numCells);
+  vector<vector<TransportUnit*> > transports(SceneGrid::numCells);
+  for (Hex::Iterator hex = Hex::start(); hex != Hex::final(); ++hex) {
+    hexes[grid.cell((*hex)->getGraphicsInfo()->getPosition())].push_back(*hex);
+  }
+  for (VertexGraphicsInfo::Iterator vertex = VertexGraphicsInfo::start(); vertex != VertexGraphicsInfo::final(); ++vertex) {
+    vertices[grid.cell((*vertex)->getPosition())].push_back(*vertex);
+  }
   for (TransportUnit::Iterator transport = TransportUnit::start(); transport != TransportUnit::final(); ++transport) {
-    Vertex* dat = (*transport)->getLocation();
-    //glEnable(GL_TEXTURE_2D);
-    triplet center = dat->getGraphicsInfo()->getPosition();
-    drawMilUnit((*transport)->getGraphicsInfo(), (*transport)->getOwner(), center, 0.0);
+    transports[grid.cell((*transport)->getLocation()->getGraphicsInfo()->getPosition())].push_back(*transport);
   }
+
+  for (unsigned int cell = 0; cell < hexes.size(); ++cell) {
+    if ((hexes[cell].empty()) && (vertices[cell].empty()) && (transports[cell].empty())) continue;
+    scene.buckets.push_back(SceneBucket());
+    SceneBucket& bucket = scene.buckets.back();
+    bucket.low = triplet(1e30, 1e30, 1e30);
+    bucket.high = triplet(-1e30, -1e30, -1e30);
+
+    for (vector<Hex*>::iterator hex = hexes[cell].begin(); hex != hexes[cell].end(); ++hex) {
+      Farmland* farm = (*hex)->getFarm();
+      Village* village = (*hex)->getVillage();
+      MilUnit* militia = village ? village->getMilitia() : 0;
+      Player* owner = (*hex)->getOwner();
+      queueHex((*hex)->getGraphicsInfo(),
+	       farm ? farm->getGraphicsInfo() : 0,
+	       village ? village->getGraphicsInfo() : 0,
+	       militia ? militia->getGraphicsInfo() : 0,
+	       owner ? owner->getGraphicsInfo() : 0,
+	       bucket.fields);
+      includeInBucket(bucket, (*hex)->getGraphicsInfo());
+    }
+    tSprite->takeOwnInstances(bucket.trees);
+    ThreeDSprite::takeInstances(bucket.villages);
+
+    for (vector<VertexGraphicsInfo*>::iterator vertex = vertices[cell].begin(); vertex != vertices[cell].end(); ++vertex) {
+      queueVertex(*vertex);
+      includeInBucket(bucket, *vertex);
+    }
+    ThreeDSprite::takeInstances(bucket.units);
+
+    for (vector<TransportUnit*>::iterator transport = transports[cell].begin(); transport != transports[cell].end(); ++transport) {
+      const GraphicsInfo* location = (*transport)->getLocation()->getGraphicsInfo();
+      queueMilUnit((*transport)->getGraphicsInfo(), (*transport)->getOwner(), location->getPosition(), 0.0, scene.transportFlags);
+      includeInBucket(bucket, location);
+    }
+    ThreeDSprite::takeInstances(bucket.transports);
+    bucket.upload();
+  }
+
+  for (LineGraphicsInfo::Iterator line = LineGraphicsInfo::start(); line != LineGraphicsInfo::final(); ++line) {
+    Castle* castle = (*line)->getGameObject()->getCastle();
+    if (!castle) continue;
+    CastleGraphicsInfo* cgi = castle->getGraphicsInfo();
+    if (!cgi) continue;
+    CastleDraw draw;
+    draw.position = cgi->getPosition();
+    draw.normal = cgi->getNormal();
+    draw.angle = cgi->getAngle();
+    draw.radius = (*line)->getRadius();
+    draw.flag = castle->getOwner()->getGraphicsInfo()->getFlagTexture();
+    scene.castles.push_back(draw);
+  }
+  scene.version = GraphicsInfo::getSceneVersion();
+}
+
+void GLDrawer::freezeScene (bool f) {
+  // Catch up first, so a frozen scene shows the state the game was left in.
+  if ((f) && (cSprite) && (scene.version != GraphicsInfo::getSceneVersion())) {
+    makeCurrent();
+    rebuildScene();
+  }
+  sceneFrozen = f;
+}
+
+static double percentile (const vector<double>& sorted, double fraction) {
+  unsigned int idx = (unsigned int) (fraction * sorted.size());
+  return sorted[min(idx, (unsigned int) sorted.size() - 1)];
+}
+
+void GLDrawer::benchmark (int frames) {
+  makeCurrent();
+  resizeGL();
+  QElapsedTimer timer;
+
+  // The first paint builds the scene and uploads the terrain, so it is
+  // reported apart from the steady state.
+  RenderStats::reset();
+  timer.start();
+  paintGL();
+  glFinish();
+  double firstFrame = timer.nsecsElapsed() * 1e-6;
+  Logger::logStream(DebugStartup) << "Render benchmark first frame: " << firstFrame << " ms, "
+				  << RenderStats::drawCalls << " draw calls, "
+				  << RenderStats::textureBinds << " texture binds, "
+				  << RenderStats::vertices << " vertices.\n";
+
+  // Scripted camera: a quarter of the frames each panning, zooming out and
+  // back in, tilting and turning, so culling and terrain detail levels
+  // both see some work.
+  vector<double> times;
+  double drawCalls = 0;
+  double textureBinds = 0;
+  double vertices = 0;
+  int phase = max(1, frames / 4);
+  for (int frame = 0; frame < frames; ++frame) {
+    int step = frame % phase;
+    switch (frame / phase) {
+    case 0:  setTranslate(step < phase / 2 ? -4 : 0, step < phase / 2 ? 0 : -4); break;
+    case 1:  if (0 == step % (1 + phase / 10)) zoom(step < phase / 2 ? -1 : 1); break;
+    case 2:  azimate(step < phase / 2 ? 0.02 : -0.02); break;
+    default: rotate(0.02); break;
+    }
+
+    RenderStats::reset();
+    timer.start();
+    paintGL();
+    glFinish();
+    times.push_back(timer.nsecsElapsed() * 1e-6);
+    drawCalls += RenderStats::drawCalls;
+    textureBinds += RenderStats::textureBinds;
+    vertices += RenderStats::vertices;
+  }
+  if (times.empty()) return;
+
+  double total = 0;
+  for (vector<double>::iterator t = times.begin(); t != times.end(); ++t) total += (*t);
+  sort(times.begin(), times.end());
+  Logger::logStream(DebugStartup) << "Render benchmark, " << frames << " frames at " << width() << "x" << height() << ": "
+				  << "mean " << total / frames << " ms, "
+				  << "median " << percentile(times, 0.5) << " ms, "
+				  << "90th " << percentile(times, 0.9) << " ms, "
+				  << "99th " << percentile(times, 0.99) << " ms, "
+				  << "worst " << times.back() << " ms.\n";
+  Logger::logStream(DebugStartup) << "Render benchmark per frame: "
+				  << drawCalls / frames << " draw calls, "
+				  << textureBinds / frames << " texture binds, "
+				  << vertices / frames << " vertices.\n";
 }
 
 void WarfareWindow::paintEvent (QPaintEvent* /*event*/) {
@@ -996,9 +1257,11 @@ void WarfareWindow::paintEvent (QPaintEvent* /*event*/) {
 
 void WarfareWindow::update () {
   hexDrawer->updateGL();
-  selDrawer->draw();
-  histDrawer->draw();
-  marketDrawer->draw();
+  if (!simulating) {
+    selDrawer->draw();
+    histDrawer->draw();
+    marketDrawer->draw();
+  }
   QMainWindow::update();
 }
 
@@ -1066,7 +1329,7 @@ void WarfareWindow::mouseReleaseEvent (QMouseEvent* event) {
       update();
       return;
     }
-    else {
+    else if (!simulating) {
       // Building castle. Selected a Vertex,
       // dragging mouse from Hex to Line.
       Hex* clickedHex = hexDrawer->findHex(mouseDownX - hexDrawer->x(), mouseDownY - hexDrawer->y());
@@ -1107,6 +1370,7 @@ void WarfareWindow::mouseReleaseEvent (QMouseEvent* event) {
     }
   }
 
+  if (simulating) return;
   Hex* clickedHex = hexDrawer->findHex(xpos - hexDrawer->x(), ypos - hexDrawer->y());
   Vertex* clickedVertex = hexDrawer->findVertex(xpos - hexDrawer->x(), ypos - hexDrawer->y());
   Line* clickedLine = hexDrawer->findLine(xpos - hexDrawer->x(), ypos - hexDrawer->y());
@@ -1378,17 +1642,67 @@ void WarfareWindow::humanAction (Action& act) {
 
   Player::advancePlayer();
   runNonHumans();
-  selectObject();
+  if (!simulating) selectObject();
 }
 
 void WarfareWindow::runNonHumans () {
-  while (!Player::getCurrentPlayer()->isHuman()) {
-    Logger::logStream(Logger::Debug) << Player::getCurrentPlayer()->getDisplayName() << "\n";
-    Player::getCurrentPlayer()->getAction();
-    if (turnEnded()) endOfTurn();
-    Player::advancePlayer();
-    Logger::logStream(Logger::Debug) << Player::getCurrentPlayer()->getDisplayName() << "\n";
+  if (Player::getCurrentPlayer()->isHuman()) return;
+  holdGame(true);
+  simulationFinished = false;
+  simulationThread = std::thread(&WarfareWindow::simulateNonHumans, this);
+}
+
+// Runs on simulationThread. Talks to the GUI only through the logs and
+// the queued simulationProgress and simulationDone signals.
+void WarfareWindow::simulateNonHumans () {
+  try {
+    while ((!stopSimulation) && (!Player::getCurrentPlayer()->isHuman())) {
+      Logger::logStream(Logger::Debug) << Player::getCurrentPlayer()->getDisplayName() << "\n";
+      emit simulationProgress(QString::fromStdString(Player::getCurrentPlayer()->getDisplayName() + " is moving"));
+      Player::getCurrentPlayer()->getAction();
+      if (turnEnded()) {
+	emit simulationProgress("End of turn");
+	endOfTurn();
+      }
+      Player::advancePlayer();
+      Logger::logStream(Logger::Debug) << Player::getCurrentPlayer()->getDisplayName() << "\n";
+    }
   }
+  catch (string errorMessage) {
+    Logger::logStream(Logger::Error) << "Exception with message " << errorMessage << " while computer players moved. Game is probably in a bad state.\n";
+  }
+  simulationFinished = true;
+  emit simulationDone();
+}
+
+void WarfareWindow::nonHumansDone () {
+  // A done signal from a thread that stopNonHumans already joined is stale.
+  if ((!simulating) || (!simulationFinished)) return;
+  simulationThread.join();
+  holdGame(false);
+  selectObject();
+  update();
+}
+
+void WarfareWindow::stopNonHumans () {
+  if (!simulationThread.joinable()) return;
+  stopSimulation = true;
+  simulationThread.join();
+  stopSimulation = false;
+  holdGame(false);
+}
+
+void WarfareWindow::holdGame (bool hold) {
+  simulating = hold;
+  hexDrawer->freezeScene(hold);
+  unitInterface->setEnabled(!hold);
+  castleInterface->setEnabled(!hold);
+  villageInterface->setEnabled(!hold);
+  if (!hold) statusBar()->clearMessage();
+}
+
+void WarfareWindow::showProgress (QString m) {
+  if (simulating) statusBar()->showMessage(m);
 }
 
 void WarfareWindow::message (QString m) {
@@ -1402,6 +1716,7 @@ void WarfareWindow::initialiseColours () {
 }
 
 void WarfareWindow::clearGame () {
+  stopNonHumans();
     if (currentGame) {
     delete currentGame;
     currentGame = 0;
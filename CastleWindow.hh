@@ -8,10 +8,15 @@
 #include "Logger.hh"
 #include "game/Action.hh"
 #include "game/Hex.hh"
+#include "graphics/Frustum.hh"
+#include "graphics/GeoGraphics.hh"
 #include "graphics/GraphicsBridge.hh"
+#include "graphics/PickGrid.hh"
 #include <iterator>
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <thread>
 
 class ThreeDSprite;
 using namespace std;
@@ -146,6 +151,8 @@ public:
   void setViewport ();
   void assignColour (Player* p);
   void setOverlayMode (MapOverlay* m) {overlayMode = m;}
+  void freezeScene (bool f);
+  void benchmark (int frames);
 
 protected:
   void convertToOGL (double& x, double& y);
@@ -154,22 +161,95 @@ protected:
   virtual void resizeGL ();
 
 private:
-  void drawCastle (Castle* castle) const;
-  void drawLine (LineGraphicsInfo const* dat);
-  void drawHex (HexGraphicsInfo const* dat,
-		FarmGraphicsInfo const* farmInfo,
-		VillageGraphicsInfo const* villageInfo,
-		MilUnitGraphicsInfo const* militiaInfo,
-		PlayerGraphicsInfo const* playerInfo);
-  void drawSprites (const SpriteContainer* info, vector<int>& texts, double angle);
-  void drawMilUnit (const SpriteContainer* unit, Player* player, triplet center, double angle);
-  void drawVertex (VertexGraphicsInfo const* dat);
+  // Flag shown above a unit. Drawn on every paint, since it turns to
+  // face the camera and scales with the zoom.
+  struct UnitFlag {
+    triplet position;
+    GLuint texture;
+  };
+
+  // Castle as it stood when the scene was built.
+  struct CastleDraw {
+    triplet position;
+    triplet normal;
+    double angle;
+    double radius; // Of the Line it stands on.
+    int flag;
+  };
+
+  void drawCastle (const CastleDraw& castle) const;
+  void queueHex (HexGraphicsInfo const* dat,
+		 FarmGraphicsInfo const* farmInfo,
+		 VillageGraphicsInfo const* villageInfo,
+		 MilUnitGraphicsInfo const* militiaInfo,
+		 PlayerGraphicsInfo const* playerInfo,
+		 ThreeDSprite::BatchList& fields);
+  void queueSprites (const SpriteContainer* info, triplet center, double angle, int flag);
+  void queueMilUnit (const SpriteContainer* unit, Player* player, triplet center, double angle, vector<UnitFlag>& flags);
+  void queueVertex (VertexGraphicsInfo const* dat);
+  void drawFlags (const vector<UnitFlag>& flags);
+  void rebuildScene ();
   void drawZone (int which);
+  int pickLod (const ZoneGraphicsInfo::TerrainTile& tile, double cellSize) const;
+  void uploadZoneMesh (int which);
+  bool visible (const GraphicsInfo* dat) const {return frustum.sphereVisible(dat->getPosition(), dat->getRadius() + cullMargin);}
   ThreeDSprite* makeSprite (Object* info);
 
+  // Terrain mesh for one zone. Held in buffer objects when the driver
+  // has them, otherwise drawn from the client-side arrays.
+  struct ZoneMesh {
+    ZoneMesh () : vertexBuffer(0), indexBuffer(0), numIndices(0), version(0) {}
+    GLuint vertexBuffer;
+    GLuint indexBuffer;
+    unsigned int numIndices;
+    unsigned int version;
+    vector<GLfloat> vertices;
+    vector<GLuint> indices;
+    vector<ZoneGraphicsInfo::TerrainTile> tiles;
+  };
+
+  // The batches for one cell of a grid over the map, with a box around
+  // everything in them, so that paintGL can cull them a cell at a time.
+  // Batches are moved into vertex buffers once the bucket is complete.
+  struct SceneBucket {
+    void upload ();
+    void release ();
+    triplet low;
+    triplet high;
+    ThreeDSprite::BatchList fields;
+    ThreeDSprite::BatchList trees;
+    ThreeDSprite::BatchList villages;
+    ThreeDSprite::BatchList units;
+    ThreeDSprite::BatchList transports;
+  };
+
+  // What paintGL draws from the game state. Rebuilt only when the
+  // GraphicsInfo scene version moves on; camera-only repaints resubmit it.
+  struct Scene {
+    Scene () : version(0) {}
+    unsigned int version;
+    vector<SceneBucket> buckets;
+    vector<UnitFlag> unitFlags;
+    vector<UnitFlag> transportFlags;
+    vector<CastleDraw> castles;
+  };
+
+  static void includeInBucket (SceneBucket& bucket, const GraphicsInfo* dat);
+
   int* errors;
   GLuint* terrainTextureIndices;
   GLuint* zoneTextures;  // Zones get their own array because their generation creates new texture names.
+  vector<ZoneMesh> zoneMeshes;
+  Scene scene;
+  bool sceneFrozen; // Game state is being changed on another thread; draw the scene as it is.
+  PickGrid<HexGraphicsInfo> hexGrid;
+  PickGrid<LineGraphicsInfo> lineGrid;
+  PickGrid<VertexGraphicsInfo> vertexGrid;
+  Frustum frustum;
+  triplet eyePosition;
+
+  static const double cullMargin;    // Allowance for sprites standing above an object's outline.
+  static const double lodPixelError; // Largest on-screen size, in pixels, of one step of a terrain tile.
 
   ThreeDSprite* cSprite;
   ThreeDSprite* tSprite;
@@ -193,6 +273,7 @@ public:
   void clearGame ();
   void newGame (string fname);
   void chooseTask (string fname, int task);
+  void renderBenchmark (string fname, int frames);
 				
 public slots:
   void newGame ();
@@ -203,8 +284,12 @@ public slots:
   void setMapMode (int m);
   void update ();
   void copyHistory ();
+  void showProgress (QString m);
+  void nonHumansDone ();
 
 signals:
+  void simulationProgress (QString m);
+  void simulationDone ();
 
 protected:
   void paintEvent(QPaintEvent *event);
@@ -227,6 +312,9 @@ private:
   void endOfTurn ();
   void initialiseGraphics();
   void runNonHumans ();
+  void simulateNonHumans ();
+  void stopNonHumans ();
+  void holdGame (bool hold);
   Player* gameOver ();
 
   void selectObject ();
@@ -236,6 +324,15 @@ private:
   Line* selectedLine;
   Vertex* selectedVertex;
 
+  // The AI players move on simulationThread, so the window stays live
+  // through their turns. While 'simulating' the GUI thread reads no game
+  // state: the map is drawn from GLDrawer's retained scene and anything
+  // that would act on or describe the game waits for nonHumansDone.
+  std::thread simulationThread;
+  bool simulating;
+  std::atomic<bool> stopSimulation;
+  std::atomic<bool> simulationFinished;
+
   int mouseDownX;
   int mouseDownY;
 
@@ -8,6 +8,7 @@ QT+=opengl
 CONFIG+=exceptions
 QMAKE_CXXFLAGS+= -Wno-unused-local-typedefs
 QMAKE_CXXFLAGS+=-std=c++11
+CONFIG(release, debug|release):DEFINES+=COMPILED_DEBUG_MASK=0
 TEMPLATE = app
 TARGET = Castles
 INCLUDEPATH += .
@@ -32,10 +33,15 @@ HEADERS += AgeTracker.hh \
            graphics/GraphicsBridge.hh \
            graphics/ThreeDSprite.hh \
            /Directions.hh \
+           graphics/Frustum.hh \
+           graphics/HeightGrid.hh \
+           graphics/PickGrid.hh \
+           graphics/RenderStats.hh \
            graphics/GeoGraphics.hh \
            game/Player.hh \
            graphics/PlayerGraphics.hh \
            game/Action.hh \
+           game/ActionLog.hh \
            graphics/BuildingGraphics.hh \
            game/MilUnit.hh \
            graphics/UnitGraphics.hh
@@ -56,10 +62,14 @@ SOURCES += AgeTracker.cc \
            game/EconActor.cc \
            graphics/GraphicsBridge.cc \
            graphics/ThreeDSprite.cc \
+           graphics/Frustum.cc \
+           graphics/HeightGrid.cc \
+           graphics/RenderStats.cc \
            graphics/GeoGraphics.cc \
            game/Player.cc \
            graphics/PlayerGraphics.cc \
            game/Action.cc \
+           game/ActionLog.cc \
            graphics/BuildingGraphics.cc \
            game/MilUnit.cc \
            graphics/UnitGraphics.cc
@@ -1,51 +1,60 @@
 #include "Logger.hh"
 #include <cassert>
+#include <cstdio>
 #include "Parser.hh"
 
 std::map<int, Logger*> Logger::logs;
+unsigned int Logger::numSlots = 0;
+
+// Partial lines are staged per thread, so that several threads can
+// log to the same stream without interleaving within a line.
+static thread_local std::vector<std::string> staging;
 
 Logger::Logger ()
   : active(true)
-  , buffer()
   , precision(-1)
+  , slot(numSlots++)
+  , files()
 {}
 
 Logger::~Logger () {}
 
+std::string& Logger::buffer () {
+  if (staging.size() <= slot) staging.resize(slot + 1);
+  return staging[slot];
+}
+
 Logger& Logger::append (unsigned int prec, double val) {
-  static char str[1000];
-  static char str2[1000];
-  sprintf(str, "%%.%if", prec);
-  sprintf(str2, str, val);
-  buffer.append(str2);
+  char str[100];
+  snprintf(str, sizeof(str), "%.*f", prec, val);
+  buffer().append(str);
   return *this;
 }
 
-Logger& Logger::operator<< (std::string dat) {
-  if (!active) return *this;
-  std::size_t linebreak = dat.find_first_of('\n');
-  if (std::string::npos == linebreak) buffer.append(dat.c_str());
-  else {
-    buffer.append(dat.substr(0, linebreak).c_str());
+void Logger::put (const std::string& dat) {
+  std::size_t start = 0;
+  std::size_t linebreak = dat.find('\n');
+  while (std::string::npos != linebreak) {
+    buffer().append(dat, start, linebreak - start);
     clearBuffer();
-    (*this) << dat.substr(linebreak+1);
+    start = linebreak + 1;
+    linebreak = dat.find('\n', start);
   }
-  return *this;
+  buffer().append(dat, start, std::string::npos);
 }
 
-Logger& Logger::operator<< (Object* dat) {
-  if (!active) return *this;
+void Logger::put (Object* dat) {
   static int indent = 0;
   for (int i = 0; i < indent; i++) {
     *this << "  ";
   }
   if (dat->isLeaf()) {
     *this << dat->getKey() << " = " << dat->getLeaf() << "\n";
-    return *this;
+    return;
   }
   if (0 != dat->numTokens()) {
     *this << dat->getKey() << " = { " << dat->getLeaf() << " }\n";
-    return *this;
+    return;
   }
 
   if (dat != Parser::topLevel) {
@@ -63,64 +72,47 @@ Logger& Logger::operator<< (Object* dat) {
     }
     *this << "} \n";
   }
-  return *this;
 }
 
-Logger& Logger::operator<< (char* dat) {
-  if (!active) return *this;
-  return ((*this) << std::string(dat));
+void Logger::put (const char* dat) {
+  put(std::string(dat));
 }
 
-Logger& Logger::operator<< (const char* dat) {
-  if (!active) return *this;
-  return ((*this) << std::string(dat));
-}
-
-Logger& Logger::operator<< (QString dat) {
-  if (!active) return *this;
-  int linebreak = dat.indexOf('\n');
-  if (-1 == linebreak) buffer.append(dat);
-  else {
-    buffer.append(dat.mid(0, linebreak));
-    clearBuffer();
-    (*this) << dat.mid(linebreak+1);
-  }
-
-  return *this;
+void Logger::put (const QString& dat) {
+  put(dat.toStdString());
 }
 
-Logger& Logger::operator<< (int dat) {
-  if (!active) return *this;
-  buffer.append(QString("%1").arg(dat));
-  return *this;
+void Logger::put (int dat) {
+  char str[32];
+  snprintf(str, sizeof(str), "%i", dat);
+  buffer().append(str);
 }
 
-Logger& Logger::operator<< (void* dat) {
-  if (!active) return *this;
-  static char strbuf[100];
-  sprintf(strbuf, "%p", dat);
-  buffer.append(strbuf);
-  return *this;
+void Logger::put (void* dat) {
+  char str[32];
+  snprintf(str, sizeof(str), "%p", dat);
+  buffer().append(str);
 }
 
-Logger& Logger::operator<< (unsigned int dat) {
-  if (!active) return *this;
-  buffer.append(QString("%1").arg(dat));
-  return *this;
+void Logger::put (unsigned int dat) {
+  char str[32];
+  snprintf(str, sizeof(str), "%u", dat);
+  buffer().append(str);
 }
 
-Logger& Logger::operator<< (double dat) {
-  if (!active) return *this;
-  if (precision > 0) append(precision, dat);
-  else buffer.append(QString("%1").arg(dat));
-  return *this;
+void Logger::put (double dat) {
+  if (precision > 0) {
+    append(precision, dat);
+    return;
+  }
+  char str[64];
+  snprintf(str, sizeof(str), "%g", dat);
+  buffer().append(str);
 }
 
-Logger& Logger::operator<< (char dat) {
-  if (!active) return *this;
+void Logger::put (char dat) {
   if ('\n' == dat) clearBuffer();
-  else buffer.append(dat);
-  return *this;
+  else buffer().push_back(dat);
 }
 
 void Logger::createStream (int idx) {
@@ -133,24 +125,89 @@ Logger& Logger::logStream (int idx) {
 }
 
 void Logger::clearBuffer () {
-  emit message(buffer);
-  buffer.clear();
+  std::string& line = buffer();
+  for (std::vector<FileLog*>::iterator f = files.begin(); f != files.end(); ++f) (*f)->write(line);
+  if (0 < receivers(SIGNAL(message(QString)))) emit message(QString::fromStdString(line));
+  line.clear();
+}
+
+LogQueue::LogQueue ()
+  : head(new Node())
+  , tail(head.load())
+{}
+
+LogQueue::~LogQueue () {
+  std::string dummy;
+  while (pop(dummy)) {}
+  delete tail;
+}
+
+void LogQueue::push (const std::string& line) {
+  Node* node = new Node();
+  node->line = line;
+  Node* prev = head.exchange(node, std::memory_order_acq_rel);
+  prev->next.store(node, std::memory_order_release);
+}
+
+bool LogQueue::pop (std::string& line) {
+  Node* next = tail->next.load(std::memory_order_acquire);
+  if (!next) return false;
+  line.swap(next->line);
+  delete tail;
+  tail = next;
+  return true;
 }
 
 FileLog::FileLog (std::string fname)
-  : writer()
+  : writer(fname.c_str(), std::ios_base::out | std::ios_base::app)
   , filename(fname)
+  , lines()
+  , done(false)
+  , pending(false)
+  , worker(&FileLog::run, this)
 {}
 
-FileLog::~FileLog () {}
+FileLog::~FileLog () {
+  {
+    std::lock_guard<std::mutex> guard(wakeLock);
+    done = true;
+  }
+  wakeUp.notify_one();
+  worker.join();
+}
+
+void FileLog::write (const std::string& line) {
+  lines.push(line);
+  {
+    std::lock_guard<std::mutex> guard(wakeLock);
+    pending = true;
+  }
+  wakeUp.notify_one();
+}
 
 void FileLog::message (QString str) {
-  writer.open(filename.c_str(), std::ios_base::out | std::ios_base::app);
-  writer << str.toStdString() << std::endl;
-  writer.close();
-  // Intended for debugging crashes,
-  // so clean after every write even though it
-  // may well be rather slow.
+  write(str.toStdString());
 }
 
-
+void FileLog::run () {
+  std::string batch;
+  std::string line;
+  while (true) {
+    bool finishing = done;
+    while (lines.pop(line)) {
+      batch += line;
+      batch += '\n';
+    }
+    if (!batch.empty()) {
+      writer << batch;
+      writer.flush();
+      batch.clear();
+    }
+    else if (finishing) break;
+    else {
+      std::unique_lock<std::mutex> guard(wakeLock);
+      wakeUp.wait(guard, [this] {return pending || done;});
+      pending = false;
+    }
+  }
+}
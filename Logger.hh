@@ -4,6 +4,11 @@
 #include <QObject> 
 #include <string> 
 #include <map> 
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "Parser.hh"
 #include <fstream>
 #include <ios> 
@@ -17,6 +22,23 @@ enum Debugs {DebugGeneral = 30,
 
 const int DebugStartup = NumDebugs+1; 
 
+// Bit (idx - DebugGeneral) selects whether debug category idx is built
+// at all; release builds set this to zero to compile them all out.
+#ifndef COMPILED_DEBUG_MASK
+#define COMPILED_DEBUG_MASK 0xFFFFFFFFu
+#endif
+
+constexpr bool logCompiledIn (int idx) {
+  return ((idx < DebugGeneral) || (idx >= NumDebugs) || (0 != ((COMPILED_DEBUG_MASK) & (1u << (idx - DebugGeneral)))));
+}
+
+// Use as LOGSTREAM(DebugAI) << act.describe() << "\n"; unlike
+// logStream, nothing to the right is evaluated unless the stream is
+// compiled in and active.
+#define LOGSTREAM(idx) if ((!logCompiledIn(idx)) || (!Logger::logStream(idx).isActive())) {} else Logger::logStream(idx)
+
+class FileLog;
+
 class Logger : public QObject {
   Q_OBJECT 
 public: 
@@ -25,20 +47,23 @@ public:
   enum DefaultLogs {Debug = 0, Trace, Game, Warning, Error}; 
 
   Logger& append (unsigned int prec, double val); 
-  
-  Logger& operator<< (std::string dat);
-  Logger& operator<< (QString dat);
-  Logger& operator<< (int dat);
-  Logger& operator<< (unsigned int dat);
-  Logger& operator<< (double dat);
-  Logger& operator<< (char dat);
-  Logger& operator<< (char* dat);
-  Logger& operator<< (const char* dat);
-  Logger& operator<< (Object* dat);
-  Logger& operator<< (void* dat); 
+
+  // The activity check is inline so that streaming into an inactive
+  // log costs the caller one branch and no formatting.
+  Logger& operator<< (std::string dat)  {if (active) put(dat);   return *this;}
+  Logger& operator<< (QString dat)      {if (active) put(dat);   return *this;}
+  Logger& operator<< (int dat)          {if (active) put(dat);   return *this;}
+  Logger& operator<< (unsigned int dat) {if (active) put(dat);   return *this;}
+  Logger& operator<< (double dat)       {if (active) put(dat);   return *this;}
+  Logger& operator<< (char dat)         {if (active) put(dat);   return *this;}
+  Logger& operator<< (char* dat)        {if (active) put(dat);   return *this;}
+  Logger& operator<< (const char* dat)  {if (active) put(dat);   return *this;}
+  Logger& operator<< (Object* dat)      {if (active) put(dat);   return *this;}
+  Logger& operator<< (void* dat)        {if (active) put(dat);   return *this;}
   void setActive (bool a) {active = a;}
   void setPrecision (int p = -1) {precision = p;}
   bool isActive () const {return active;} 
+  void attach (FileLog* f) {files.push_back(f);}
   
   static void createStream (int idx); 
   static Logger& logStream (int idx); 
@@ -47,31 +72,73 @@ signals:
   void message (QString m);
   
 private:
+  void put (const std::string& dat);
+  void put (const QString& dat);
+  void put (int dat);
+  void put (unsigned int dat);
+  void put (double dat);
+  void put (char dat);
+  void put (const char* dat);
+  void put (Object* dat);
+  void put (void* dat);
   void clearBuffer (); 
+  std::string& buffer ();
   
   bool active;
-  QString buffer; 
   int precision;
+  unsigned int slot;  // Index of this stream's line buffer in each thread's staging area.
+  std::vector<FileLog*> files;
   
   static std::map<int, Logger*> logs; 
+  static unsigned int numSlots;
+};
+
+// Multiple-producer, single-consumer queue of log lines, after Vyukov.
+// push is wait-free for any number of threads; only the writer thread pops.
+class LogQueue {
+public:
+  LogQueue ();
+  ~LogQueue ();
+  void push (const std::string& line);
+  bool pop (std::string& line);
+
+private:
+  struct Node {
+    Node () : next(0) {}
+    std::atomic<Node*> next;
+    std::string line;
+  };
+
+  std::atomic<Node*> head;
+  Node* tail;
 };
 
 class FileLog : public QObject {
   // Helper class for copying a log stream to a file.
-  // Intended for debugging.
+  // Lines are queued and written in batches by a background
+  // thread, which sleeps until write or the destructor wakes it;
+  // the file is flushed after each batch and on destruction.
   Q_OBJECT
 
 public:
   FileLog (std::string fname);
   ~FileLog ();
+  void write (const std::string& line);
 
 public slots:
   void message (QString str);
 
 private:
+  void run ();
+
   std::ofstream writer;
   std::string filename; 
+  LogQueue lines;
+  std::atomic<bool> done;
+  bool pending;
+  std::mutex wakeLock;
+  std::condition_variable wakeUp;
+  std::thread worker;
 };
 
 #endif
- 
@@ -1,2 +1,5 @@
 #include "Mirrorable.hh" 
 
+
+unsigned int MirrorTracking::epoch = 0;
+unsigned int MirrorTracking::depth = 0;
@@ -23,31 +23,64 @@ struct AiValue {
   }
 };
 
+// Lets setMirrorState skip objects whose mirror is already in sync.
+// While a Scope is open, real objects are assumed to change only
+// through calls to touch(); opening one invalidates every earlier sync.
+struct MirrorTracking {
+  struct Scope {
+    Scope () {++epoch; ++depth;}
+    ~Scope () {--depth;}
+  };
+
+  static bool active () {return (0 < depth);}
+  static unsigned int epoch;
+  static unsigned int depth;
+};
+
 template <class T> class Mirrorable {
 public:
-  Mirrorable (T* r = 0) : mirror(0), real(r) {
-    if (!real) {
-      real = static_cast<T*>(this);
-      mirror = new T(real); 
-    }
+  // A real object's mirror is only created the first time someone asks
+  // for it, so objects the AI never looks at never pay for one.
+  Mirrorable (T* r = 0) : real(r), mirror(0), version(0), syncedEpoch(0), syncedVersion(0), syncedMirrorVersion(0) {
+    if (!real) real = static_cast<T*>(this);
     else mirror = static_cast<T*>(this);
   }
 
   // Destruction sequence here is confusing. 
   virtual ~Mirrorable () {if (real == this) delete mirror;}
   virtual void setMirrorState () = 0; 
-  T* getMirror () {return mirror;}
-  T const* getMirror () const {return mirror;}
+  T* getMirror () {if (!mirror) createMirror(); return mirror;}
+  T const* getMirror () const {if (!mirror) createMirror(); return mirror;}
   T* getReal () {return real;}
+  bool hasMirror () const {return (0 != mirror);}
   void destroyIfReal () {if (isReal()) delete this;}
   AiValue value; 
   bool isMirror () const {return mirror == this;}
   bool isReal () const {return real == this;}   
+  // Marks this object, real or mirror, as changed since it was last synced.
+  void touch () {++version;}
   
 protected:
-  T* mirror;
+  bool mirrorIsCurrent () const {
+    if ((!MirrorTracking::active()) || (!mirror)) return false;
+    return ((syncedEpoch == MirrorTracking::epoch) && (syncedVersion == version) && (syncedMirrorVersion == static_cast<Mirrorable<T>*>(mirror)->version));
+  }
+  void markMirrored () {
+    syncedEpoch = MirrorTracking::epoch;
+    syncedVersion = version;
+    syncedMirrorVersion = static_cast<Mirrorable<T>*>(getMirror())->version;
+  }
+
   T* real; 
+
 private:
+  void createMirror () const {mirror = new T(real);}
+
+  mutable T* mirror;
+  unsigned int version;
+  unsigned int syncedEpoch;
+  unsigned int syncedVersion;
+  unsigned int syncedMirrorVersion;
 };
 
 template <class T, class K> void addContent (T* dis,
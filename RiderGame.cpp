@@ -5,6 +5,8 @@
 #include <list>
 #include "boost/function.hpp"
 #include "boost/bind.hpp"
+#include "game/Action.hh"
+#include "game/ActionLog.hh"
 #include "game/Market.hh"
 #include "game/MilUnit.hh"
 #include "game/Hex.hh"
@@ -48,7 +50,7 @@ WarfareGame::~WarfareGame () {
 WarfareGame* WarfareGame::createGame (string filename) {
   Logger::logStream(DebugStartup) << "Entering createGame " << currGame << "\n";
   //srand(time(NULL));
-  srand(42);
+  ActionLog::newGame();
   if (currGame) delete currGame;
   Logger::logStream(DebugStartup) << "Creating new game\n";
   currGame = new WarfareGame();
@@ -157,6 +159,7 @@ void WarfareGame::findCastles (vector<Castle*>& ret, Player* p) {
 }
 
 void WarfareGame::endOfTurn () {
+  ActionLog::reseed();
   TextInfo::clearRecentEvents();
   updateGreatestMilStrength();
   for (ContractInfo::Iter c = ContractInfo::start(); c != ContractInfo::final(); ++c) (*c)->execute();
@@ -233,6 +236,65 @@ void WarfareGame::unitComparison (string fname) {
   
 }
 
+bool allPlayersFinished () {
+  for (Player::Iter pl = Player::start(); pl != Player::final(); ++pl) {
+    if (!(*pl)->turnEnded()) return false;
+  }
+  return true;
+}
+
+void WarfareGame::replayGame (string fname, string logname) {
+  if (!ActionLog::openReplay(logname)) {
+    Logger::logStream(DebugStartup) << "Could not read action log " << logname << "\n";
+    return;
+  }
+  createGame(fname);
+
+  // Mirrors WarfareWindow::humanAction and runNonHumans, with the
+  // AI's choices taken from the log instead of recomputed.
+  Action act;
+  Action::ActionResult logged = Action::Ok;
+  Outcome loggedOutcome = Neutral;
+  int actions = 0;
+  int turns = 0;
+  int divergences = 0;
+  clock_t startTime = clock();
+  try {
+    while (ActionLog::readAction(act, logged, loggedOutcome)) {
+      ++actions;
+      if (act.player != Player::getCurrentPlayer()) {
+	Logger::logStream(DebugStartup) << "Replay action " << actions << " by " << act.player->getName()
+					<< " but current player is " << Player::getCurrentPlayer()->getName() << "\n";
+	++divergences;
+      }
+      Action::ActionResult res = act.execute();
+      if ((res != logged) || ((Action::Ok == res) && (act.result != loggedOutcome))) {
+	Logger::logStream(DebugStartup) << "Replay diverges at action " << actions << ", " << act.describe()
+					<< ": logged " << outcomeToString(loggedOutcome) << " " << (int) logged
+					<< ", got " << outcomeToString(act.result) << " " << (int) res << "\n";
+	++divergences;
+      }
+      if ((act.player->isHuman()) && (Action::Ok != res) && (Action::AttackFails != res)) continue;
+      act.player->finished();
+      if (allPlayersFinished()) {
+	currGame->endOfTurn();
+	for (Player::Iter pl = Player::start(); pl != Player::final(); ++pl) (*pl)->newTurn();
+	++turns;
+      }
+      Player::advancePlayer();
+    }
+  }
+  catch (string problem) {
+    Logger::logStream(DebugStartup) << "Replay failed after " << actions << " actions with error " << problem << "\n";
+  }
+  ActionLog::closeReplay();
+
+  double seconds = clock() - startTime;
+  seconds /= CLOCKS_PER_SEC;
+  Logger::logStream(DebugStartup) << "Replayed " << actions << " actions over " << turns << " turns in "
+				  << seconds << " seconds with " << divergences << " divergences.\n";
+}
+
 int tests = 0;
 int passed = 0;
 
@@ -24,6 +24,7 @@ public:
   static void unitComparison (string fname);
   static void unitTests (string fname);
   static void functionalTests (string fname);
+  static void replayGame (string fname, string logname);
   static void updateGreatestMilStrength ();    
   
 private:
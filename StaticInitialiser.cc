@@ -1,8 +1,10 @@
 #include "StaticInitialiser.hh"
 
 #include <fstream>
+#include <thread>
 #include "glextensions.h"
 #include <GL/glu.h>
+#include <QDir>
 #include <QGLFramebufferObject>
 #include <QGLShader>
 #include <QGLShaderProgram>
@@ -433,13 +435,13 @@ void StaticInitialiser::initialiseGraphics (Object* gInfo) {
   GraphicsInfo::zoneSide = gInfo->safeGetInt("zoneSide", 4);
   int mapWidth = heightMapWidth(GraphicsInfo::zoneSide);
   int mapHeight = heightMapHeight(GraphicsInfo::zoneSide);
-  GraphicsInfo::heightMap = new double[mapWidth*mapHeight];
+  GraphicsInfo::heightMap.resize(mapWidth, mapHeight);
 
   QImage b("gfx/heightmap.bmp");
   for (int x = 0; x < mapWidth; ++x) {
     for (int y = 0; y < mapHeight; ++y) {
       QRgb pix = b.pixel(x, y);
-      GraphicsInfo::heightMap[mapWidth*y + x] = qRed(pix);
+      GraphicsInfo::heightMap.at(x, y) = qRed(pix);
     }
   }
 
@@ -848,50 +850,31 @@ void StaticInitialiser::createPlayer (Object* info) {
   ret->getGraphicsInfo()->colour = qRgb(red, green, blue);
 }
 
-double StaticInitialiser::interpolate (double xfrac, double yfrac, int mapWidth, int mapHeight, double* heightMap) {
-  const double binWidth = 1.0 / mapWidth;
-  const double binHeight = 1.0 / mapHeight;
-
-  int xbin = (int) floor(xfrac * mapWidth);
-  int ybin = (int) floor(yfrac * mapHeight);
-  int nextXbin = min(xbin+1, mapWidth-1);
-  int nextYbin = min(ybin+1, mapHeight-1);
-
-  double height1 = heightMap[ybin*mapWidth + xbin];
-  double height2 = heightMap[ybin*mapWidth + nextXbin];
-  double height3 = heightMap[nextYbin*mapWidth + xbin];
-  double height4 = heightMap[nextYbin*mapWidth + nextXbin];
-
-  xfrac -= binWidth*xbin;
-  xfrac /= binWidth;
-  yfrac -= binHeight*ybin;
-  yfrac /= binHeight;
-
-  double ret = (1-xfrac)*(1-yfrac) * height1;
-  ret       +=    xfrac *(1-yfrac) * height2;
-  ret       += (1-xfrac)*   yfrac  * height3;
-  ret       +=    xfrac *   yfrac  * height4;
-
-  return ret;
+// Calls rowFunc(row) for each row in [0, rows), spread over the hardware
+// threads. Rows are dealt out in turn, so uneven rows still share evenly.
+template <class F> void forEachRow (int rows, F rowFunc) {
+  int numThreads = max(1, min(rows, (int) std::thread::hardware_concurrency()));
+  vector<std::thread> workers;
+  for (int t = 1; t < numThreads; ++t) {
+    workers.push_back(std::thread([=] () {for (int row = t; row < rows; row += numThreads) rowFunc(row);}));
+  }
+  for (int row = 0; row < rows; row += numThreads) rowFunc(row);
+  for (unsigned int t = 0; t < workers.size(); ++t) workers[t].join();
 }
 
 void StaticInitialiser::addShadows (QGLFramebufferObject* fbo, GLuint texture) {
-  static bool shaded[GraphicsInfo::zoneSize];
   static double lightAngle = tan(30.0 / 180.0 * M_PI);
   static double invSize = 2.0 / GraphicsInfo::zoneSize;
 
   ZoneGraphicsInfo* zoneInfo = ZoneGraphicsInfo::getByIndex(0);
 
   // Seed detailed heightmap using coarse one.
-  for (int yval = 0; yval < GraphicsInfo::zoneSize; ++yval) {
+  forEachRow(GraphicsInfo::zoneSize, [zoneInfo] (int yval) {
+    float* heights = zoneInfo->heightMap.row(yval);
     for (int xval = 0; xval < GraphicsInfo::zoneSize; ++xval) {
-      zoneInfo->heightMap[xval][yval] = interpolate(((double) xval)/GraphicsInfo::zoneSize,
-						    ((double) yval)/GraphicsInfo::zoneSize,
-						    heightMapWidth(GraphicsInfo::zoneSide),
-						    heightMapHeight(GraphicsInfo::zoneSide),			
-						    GraphicsInfo::heightMap);
+      heights[xval] = GraphicsInfo::heightMap.sample(((double) xval)/GraphicsInfo::zoneSize, ((double) yval)/GraphicsInfo::zoneSize);
     }
-  }
+  });
 
   // Square/diamond fractal
   vector<QRect> squares;
@@ -1031,53 +1014,63 @@ void StaticInitialiser::addShadows (QGLFramebufferObject* fbo, GLuint texture) {
     iter++;
   }
 
-  for (int yval = 0; yval < GraphicsInfo::zoneSize; ++yval) {
+  HeightGrid modulateGrid(modSize, modSize);
+  for (int y = 0; y < modSize; ++y) {
+    for (int x = 0; x < modSize; ++x) modulateGrid.at(x, y) = modulate[y*modSize + x];
+  }
+  forEachRow(GraphicsInfo::zoneSize, [zoneInfo, &modulateGrid] (int yval) {
+    float* heights = zoneInfo->heightMap.row(yval);
+    double yfrac = yval;
+    yfrac /= GraphicsInfo::zoneSize;
     for (int xval = 0; xval < GraphicsInfo::zoneSize; ++xval) {
       double xfrac = xval;
       xfrac /= GraphicsInfo::zoneSize;
-      double yfrac = yval;
-      yfrac /= GraphicsInfo::zoneSize;
-      zoneInfo->heightMap[xval][yval] += interpolate(xfrac, yfrac, modSize, modSize, modulate);
+      heights[xval] += modulateGrid.sample(xfrac, yfrac);
     }
-  }
-
-  for (int yval = 0; yval < GraphicsInfo::zoneSize; ++yval) {
-    // First calculate all the point heights.
-    for (int xval = 0; xval < GraphicsInfo::zoneSize; ++xval) {
-      shaded[xval] = false;
-    }
-
+  });
+
+  // Shadows run along x, so each row of the map is independent; work them
+  // all out first, since only this thread may draw into the fbo.
+  vector<char> shaded(GraphicsInfo::zoneSize * GraphicsInfo::zoneSize, 0);
+  forEachRow(GraphicsInfo::zoneSize, [zoneInfo, &shaded] (int yval) {
+    const float* heights = zoneInfo->heightMap.row(yval);
+    char* rowShaded = &shaded[yval * GraphicsInfo::zoneSize];
     // For each point, throw a shadow to the right.
     for (int xval = 0; xval < GraphicsInfo::zoneSize; ++xval) {
-      double xHeight = zoneInfo->heightMap[xval][yval];
+      double xHeight = heights[xval];
       for (int cand = xval + 1; cand < GraphicsInfo::zoneSize; ++cand) {
-	if (shaded[cand]) continue;
-	double candHeight = zoneInfo->heightMap[cand][yval];
+	if (rowShaded[cand]) continue;
+	double candHeight = heights[cand];
 	if (cand - xval > (xHeight - candHeight)*lightAngle) continue; // X point does not shade this candidate.
-	shaded[cand] = true;
+	rowShaded[cand] = 1;
       }
     }
+  });
 
-    // Draw the shadow texture and scale to graphics step.
+  // Draw the shadow texture and scale to graphics step.
+  zoneInfo->heightMap.scale(GraphicsInfo::zSeparation);
+  for (int yval = 0; yval < GraphicsInfo::zoneSize; ++yval) {
     for (int xval = 0; xval < GraphicsInfo::zoneSize; ++xval) {
-      zoneInfo->heightMap[xval][yval] *= GraphicsInfo::zSeparation;
-      if (!shaded[xval]) continue;
+      if (!shaded[yval * GraphicsInfo::zoneSize + xval]) continue;
       QRectF point(xval*invSize - 1, yval*invSize - 1, invSize * 1.5, invSize * 1.5);
       fbo->drawTexture(point, texture);
     }
   }
+  zoneInfo->heightsChanged();
 }
 
-void createTexture (QGLFramebufferObject* fbo, int minHeight, int maxHeight, double* heightMap, int mapWidth, GLuint texture) {
+void createTexture (QGLFramebufferObject* fbo, int minHeight, int maxHeight, const HeightGrid& heightMap, GLuint texture) {
   // Corners of texture are at (-1, -1) and (1, 1) because drawTexture uses model space
   // and the glOrtho call above.
 
   int repeats = 3;
+  int mapWidth = heightMap.getColumns();
+  int mapHeight = heightMap.getRows();
 
   double xstep = 2;
   xstep /= (mapWidth-1); // Not calculating bin centers. Last bin edge should be on GraphicsInfo::zoneSize, or 2 in model space.
   double ystep = 2;
-  ystep /= (mapWidth+2-1);
+  ystep /= (mapHeight-1);
 
   xstep /= repeats;
   ystep /= repeats;
@@ -1085,9 +1078,9 @@ void createTexture (QGLFramebufferObject* fbo, int minHeight, int maxHeight, dou
   const static double overlap = 2.00;
 
   for (int x = 0; x < mapWidth; ++x) {
-    for (int y = 0; y < mapWidth+2; ++y) {
-      if (heightMap[y*mapWidth + x] < minHeight) continue;
-      if (heightMap[y*mapWidth + x] > maxHeight) continue;
+    for (int y = 0; y < mapHeight; ++y) {
+      if (heightMap.at(x, y) < minHeight) continue;
+      if (heightMap.at(x, y) > maxHeight) continue;
 
 
       for (int i = 0; i < repeats; ++i) {
@@ -1201,7 +1194,7 @@ void StaticInitialiser::makeGraphicsInfoObjects () {
       if (vex->graphicsInfo) continue;
       vex->graphicsInfo = new VertexGraphicsInfo(vex, hexGraphics, convertToVertex(i));
       vex->position = vex->graphicsInfo->position;
-      vex->mirror->position = vex->graphicsInfo->position;
+      vex->getMirror()->position = vex->graphicsInfo->position;
     }
     if ((*h)->village) {
       (*h)->village->getGraphicsInfo()->generateShapes(hexGraphics);
@@ -1213,15 +1206,135 @@ void StaticInitialiser::makeGraphicsInfoObjects () {
   for (Line::Iterator l = Line::start(); l != Line::final(); ++l) {
     (*l)->graphicsInfo = new LineGraphicsInfo((*l), (*l)->vex1->getDirection((*l)->vex2));
     (*l)->position = (*l)->graphicsInfo->position;
-    (*l)->mirror->position = (*l)->graphicsInfo->position;
+    (*l)->getMirror()->position = (*l)->graphicsInfo->position;
     if ((*l)->getCastle()) {
       (*l)->getCastle()->initialiseBridge();
     }
   }
+
+  GLDrawer* hexDrawer = WarfareWindow::currWindow->hexDrawer;
+  hexDrawer->hexGrid.build();
+  hexDrawer->lineGrid.build();
+  hexDrawer->vertexGrid.build();
+}
+
+// Generated terrain, keyed by a hash of everything that goes into it
+// except the random numbers. Layout, native byte order:
+//   'C' 'T' 'R' 'N', uint32 version, uint64 key, int32 zoneSize,
+//   zoneSize^2 floats of detailed heightmap (row by row),
+//   zoneSize^2 RGBA pixels of zone texture.
+static const char terrainCacheMagic[4] = {'C', 'T', 'R', 'N'};
+static const unsigned int terrainCacheVersion = 2;
+
+static void hashBytes (unsigned long long& hash, const void* dat, unsigned int bytes) {
+  // FNV-1a.
+  const unsigned char* curr = (const unsigned char*) dat;
+  for (unsigned int i = 0; i < bytes; ++i) {
+    hash ^= curr[i];
+    hash *= 1099511628211ULL;
+  }
+}
+
+static unsigned long long terrainCacheKey (Object* terrainTextures) {
+  unsigned long long ret = 14695981039346656037ULL;
+  int zoneSize = GraphicsInfo::zoneSize;
+  hashBytes(ret, &terrainCacheVersion, sizeof(terrainCacheVersion));
+  hashBytes(ret, &zoneSize, sizeof(zoneSize));
+  int mapWidth = heightMapWidth(GraphicsInfo::zoneSide);
+  int mapHeight = heightMapHeight(GraphicsInfo::zoneSide);
+  hashBytes(ret, &mapWidth, sizeof(mapWidth));
+  hashBytes(ret, &mapHeight, sizeof(mapHeight));
+  for (int y = 0; y < mapHeight; ++y) hashBytes(ret, GraphicsInfo::heightMap.row(y), mapWidth * sizeof(float));
+  objvec terrains = terrainTextures->getValue("height");
+  for (objiter t = terrains.begin(); t != terrains.end(); ++t) {
+    string file = remQuotes((*t)->safeGetString("file"));
+    int minHeight = (*t)->safeGetInt("minimum");
+    int maxHeight = (*t)->safeGetInt("maximum");
+    hashBytes(ret, file.c_str(), file.size() + 1);
+    hashBytes(ret, &minHeight, sizeof(minHeight));
+    hashBytes(ret, &maxHeight, sizeof(maxHeight));
+  }
+  return ret;
+}
+
+static string terrainCacheName (unsigned long long key) {
+  sprintf(strbuffer, "./cache/terrain_%016llx.bin", key);
+  return strbuffer;
+}
+
+bool StaticInitialiser::readTerrainCache (unsigned long long key, GLuint& texture) {
+  string fname = terrainCacheName(key);
+  ifstream reader(fname.c_str(), ios::in | ios::binary);
+  if (!reader.good()) return false;
+  char magic[4];
+  unsigned int version = 0;
+  unsigned long long storedKey = 0;
+  int size = 0;
+  reader.read(magic, sizeof(magic));
+  reader.read((char*) &version, sizeof(version));
+  reader.read((char*) &storedKey, sizeof(storedKey));
+  reader.read((char*) &size, sizeof(size));
+  if ((!reader.good()) || (!equal(magic, magic + 4, terrainCacheMagic)) || (terrainCacheVersion != version) || (key != storedKey) || (GraphicsInfo::zoneSize != size)) {
+    Logger::logStream(Logger::Warning) << "Ignoring unreadable terrain cache " << fname << ".\n";
+    return false;
+  }
+
+  ZoneGraphicsInfo* zoneInfo = ZoneGraphicsInfo::getByIndex(0);
+  HeightGrid heights(size, size);
+  vector<unsigned char> pixels(size * size * 4);
+  for (int y = 0; y < size; ++y) reader.read((char*) heights.row(y), size * sizeof(float));
+  reader.read((char*) &pixels[0], pixels.size());
+  if (!reader.good()) {
+    Logger::logStream(Logger::Warning) << "Ignoring truncated terrain cache " << fname << ".\n";
+    return false;
+  }
+  for (int y = 0; y < size; ++y) copy(heights.row(y), heights.row(y) + size, zoneInfo->heightMap.row(y));
+  zoneInfo->heightsChanged();
+
+  // Same parameters as the framebuffer texture it replaces.
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+  return true;
+}
+
+void StaticInitialiser::writeTerrainCache (unsigned long long key, GLuint texture) {
+  string fname = terrainCacheName(key);
+  QDir().mkpath(QFileInfo(fname.c_str()).path());
+  ofstream writer(fname.c_str(), ios::out | ios::binary | ios::trunc);
+  if (!writer.good()) {
+    Logger::logStream(Logger::Warning) << "Could not open terrain cache " << fname << ", terrain will be generated again next time.\n";
+    return;
+  }
+
+  int size = GraphicsInfo::zoneSize;
+  ZoneGraphicsInfo* zoneInfo = ZoneGraphicsInfo::getByIndex(0);
+  vector<unsigned char> pixels(size * size * 4);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+
+  writer.write(terrainCacheMagic, sizeof(terrainCacheMagic));
+  writer.write((const char*) &terrainCacheVersion, sizeof(terrainCacheVersion));
+  writer.write((const char*) &key, sizeof(key));
+  writer.write((const char*) &size, sizeof(size));
+  for (int y = 0; y < size; ++y) writer.write((const char*) zoneInfo->heightMap.row(y), size * sizeof(float));
+  writer.write((const char*) &pixels[0], pixels.size());
 }
 
 void StaticInitialiser::makeZoneTextures (Object* ginfo) {
   GLDrawer* hexDrawer = WarfareWindow::currWindow->hexDrawer;
+  Object* terrainTextures = ginfo->safeGetObject("terrainTextures");
+  assert(terrainTextures);
+  hexDrawer->zoneTextures = new GLuint[1];
+  unsigned long long cacheKey = terrainCacheKey(terrainTextures);
+  if (readTerrainCache(cacheKey, hexDrawer->zoneTextures[0])) {
+    Logger::logStream(DebugStartup) << "Terrain read from " << terrainCacheName(cacheKey) << "\n";
+    return;
+  }
 
   //const char* names[NoTerrain] = {"mountain.bmp", "hill.bmp", "gfx\\grass.png", "forest.bmp", "ocean.bmp"};
   //QColor colours[NoTerrain] = {Qt::gray, Qt::lightGray, Qt::yellow, Qt::green, Qt::blue};
@@ -1288,17 +1401,14 @@ void StaticInitialiser::makeZoneTextures (Object* ginfo) {
 
   glMatrixMode(GL_MODELVIEW);
 
-  Object* terrainTextures = ginfo->safeGetObject("terrainTextures");
-  assert(terrainTextures);
   objvec terrains = terrainTextures->getValue("height");
   assert(terrains.size());
   hexDrawer->terrainTextureIndices = new GLuint[terrains.size()];
-  hexDrawer->zoneTextures = new GLuint[1];
   for (unsigned int i = 0; i < terrains.size(); ++i) {
     hexDrawer->terrainTextureIndices[i] = loadTexture(remQuotes(terrains[i]->safeGetString("file")), Qt::blue);
     int minHeight = terrains[i]->safeGetInt("minimum");
     int maxHeight = terrains[i]->safeGetInt("maximum");
-    createTexture(fbo, minHeight, maxHeight, GraphicsInfo::heightMap, heightMapWidth(GraphicsInfo::zoneSide), hexDrawer->terrainTextureIndices[i]);
+    createTexture(fbo, minHeight, maxHeight, GraphicsInfo::heightMap, hexDrawer->terrainTextureIndices[i]);
   }
 
   GLuint shadowTexture = 0;
@@ -1321,6 +1431,7 @@ void StaticInitialiser::makeZoneTextures (Object* ginfo) {
   fbo->release();
   hexDrawer->setViewport();
   hexDrawer->zoneTextures[0] = fbo->texture();
+  writeTerrainCache(cacheKey, hexDrawer->zoneTextures[0]);
 
   //shadProg.release();
 }
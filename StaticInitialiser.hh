@@ -123,8 +123,9 @@ private:
   template<class T> static void initialiseIndustry(Object* industryObject);
     
   static void addShadows (QGLFramebufferObject* fbo, GLuint texture); 
+  static bool readTerrainCache (unsigned long long key, GLuint& texture);
+  static void writeTerrainCache (unsigned long long key, GLuint texture);
   static void createCalculator (Object* info, Action::Calculator* ret);
-  static double interpolate (double xfrac, double yfrac, int width, int height, double* heightMap);
   static void setPlayer (Unit* unit, Object* mInfo);
   static void writeGoodsHolderIntoObject (const GoodsHolder& goodsHolder, Object* info);
   static void writeContractInfoIntoObject (MarketContract* contract, Object* info);
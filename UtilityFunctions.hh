@@ -4,6 +4,7 @@
 #include <climits>
 #include <cstdlib>
 #include <map>
+#include <unordered_map>
 #include <cassert>
 #include <cmath> 
 #include <string>
@@ -155,15 +156,18 @@ class MilStrength {
 template <class T> class Iterable {
  public:
 
-  Iterable<T> (int /*i*/) {} // Constructor for mirrors, which we don't want to iterate over. Don't make it empty, to avoid accidents. 
-  Iterable<T> (T* dat) {allThings.push_back(dat);} 
+  Iterable<T> (int /*i*/) : slot(UINT_MAX), entityId(UINT_MAX) {} // Constructor for mirrors, which we don't want to iterate over. Don't make it empty, to avoid accidents. 
+  Iterable<T> (T* dat) : slot(allThings.size()), entityId(newEntityId()) {allThings.push_back(dat);} 
+  Iterable<T> (const Iterable<T>& /*other*/) : slot(UINT_MAX), entityId(UINT_MAX) {} // Copies are not registered.
+  Iterable<T>& operator= (const Iterable<T>& /*other*/) {return *this;}
   ~Iterable<T> () {
-    for (unsigned int i = 0; i < allThings.size(); ++i) {
-      if (allThings[i] != this) continue;
-      allThings[i] = allThings.back();
-      allThings.pop_back(); 
-      break;
-    }
+    if (UINT_MAX == slot) return;
+    // Swap-remove; the object moved into our slot is told its new position.
+    T* last = allThings.back();
+    allThings[slot] = last;
+    const_cast<Iterable<T>*>(static_cast<const Iterable<T>*>(last))->slot = slot;
+    allThings.pop_back();
+    freeIds.push_back(entityId);
   }
 
   typedef typename vector<T*>::iterator Iter;
@@ -176,18 +180,40 @@ template <class T> class Iterable {
   static rIter rstart () {return allThings.rbegin();}
   static rIter rfinal () {return allThings.rend();}
 
+  // Position in the iteration order; changes when other objects are destroyed.
+  unsigned int getSlot () const {return slot;}
+  // Fixed for the object's lifetime, and recycled after it is destroyed,
+  // so it is always below idCapacity(). Use it to index side tables.
+  unsigned int getEntityId () const {return entityId;}
+  static unsigned int idCapacity () {return numIds;}
+
   static unsigned int totalAmount () {return allThings.size();}
   static void clear () {
     while (0 < totalAmount()) {
       delete allThings.back();
     }
+    freeIds.clear();
+    numIds = 0;
   }
 
  private:
+  static unsigned int newEntityId () {
+    if (freeIds.empty()) return numIds++;
+    unsigned int ret = freeIds.back();
+    freeIds.pop_back();
+    return ret;
+  }
+
+  unsigned int slot;
+  unsigned int entityId;
   static vector<T*> allThings;
+  static vector<unsigned int> freeIds;
+  static unsigned int numIds;
 };
 
 template <class T> vector<T*> Iterable<T>::allThings; 
+template <class T> vector<unsigned int> Iterable<T>::freeIds;
+template <class T> unsigned int Iterable<T>::numIds = 0;
 
 template <class T> class Finalizable {
 public:
@@ -208,22 +234,37 @@ template<class T> bool Finalizable<T>::s_Final = false;
 
 template<class T, bool unique=true> class Named {
 public:
-  Named (string n, T* dat) : name(n) {if (unique) assert(!nameToObjectMap[name]); nameToObjectMap[name] = dat;}
-  Named () : name("ToBeNamed") {}
-  string getName () const {return name;}
-  string getName (int space) const {return name + string("").insert(0, space - name.size(), ' ');}
-  void resetName (string n) {T* dat = nameToObjectMap[name]; assert(dat); nameToObjectMap[n] = dat; name = n;}
+  // Builds the name of an object that was given one lazily.
+  typedef string (*NameGenerator) (T const* dat);
+
+  Named (string n, T* dat) : name(n), generator(0) {if (unique) assert(!getByName(name)); nameToObjectMap[name] = dat;}
+  Named () : name("ToBeNamed"), generator(0) {}
+  string getName () const {if (generator) realiseName(); return name;}
+  string getName (int space) const {string n = getName(); return n + string("").insert(0, space - n.size(), ' ');}
+  void resetName (string n) {if (generator) realiseName(); T* dat = nameToObjectMap[name]; assert(dat); nameToObjectMap[n] = dat; name = n;}
   // Use setName for objects that don't have a name yet.
-  void setName (string n) {assert(name == "ToBeNamed"); if (unique) assert(!nameToObjectMap[n]); nameToObjectMap[n] = (T*) this; name = n;}
-  static T* getByName (string n) {assert(unique); return nameToObjectMap[n];}
-  static T* findByName (string n) {return getByName(n);}
+  void setName (string n) {assert(name == "ToBeNamed"); if (unique) assert(!getByName(n)); nameToObjectMap[n] = (T*) this; name = n;}
+  // For objects too numerous to build every name up front: the name is
+  // made, and registered for getByName, the first time it is asked for.
+  void setNameGenerator (NameGenerator g) {assert(!isNamed()); generator = g;}
+  bool isNamed () const {return ((0 != generator) || (name != "ToBeNamed"));}
+  static T* getByName (const string& n) {assert(unique); typename unordered_map<string, T*>::const_iterator i = nameToObjectMap.find(n); return (i == nameToObjectMap.end() ? 0 : i->second);}
+  static T* findByName (const string& n) {return getByName(n);}
   static void clear () {nameToObjectMap.clear();}
 private:
+  void realiseName () const {
+    NameGenerator g = generator;
+    Named<T, unique>* self = const_cast<Named<T, unique>*>(this);
+    self->generator = 0;
+    self->setName(g((T const*) this));
+  }
+
   string name;
-  static map<string, T*> nameToObjectMap;
+  NameGenerator generator;
+  static unordered_map<string, T*> nameToObjectMap;
 };
 
-template<class T, bool unique> map<string, T*> Named<T, unique>::nameToObjectMap;
+template<class T, bool unique> unordered_map<string, T*> Named<T, unique>::nameToObjectMap;
 
 template<class T> class Numbered {
 public:
@@ -308,6 +349,31 @@ private:
   vector<T*> toCall;
 };
 
+// Free-list allocator for objects with individual lifetimes; freed
+// slots are handed out again before any new block is requested.
+template<class T> class ObjectPool {
+public:
+  ObjectPool (unsigned int bs = 64) : blockSize(bs) {}
+  ~ObjectPool () {BOOST_FOREACH(char* block, blocks) ::operator delete(block);}
+
+  void* allocate () {
+    if (freeSlots.empty()) {
+      char* block = (char*) ::operator new(sizeof(T) * blockSize);
+      blocks.push_back(block);
+      for (unsigned int i = blockSize; i > 0; --i) freeSlots.push_back(block + sizeof(T) * (i-1));
+    }
+    void* ret = freeSlots.back();
+    freeSlots.pop_back();
+    return ret;
+  }
+  void release (void* dat) {if (dat) freeSlots.push_back(dat);}
+
+private:
+  unsigned int blockSize;
+  vector<char*> blocks;
+  vector<void*> freeSlots;
+};
+
 #define REMOVE(from, dis) from.erase(find(from.begin(), from.end(), dis))
 string createString (const char* format, ...);
 void throwFormatted (const char* format, ...);
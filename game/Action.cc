@@ -1,4 +1,5 @@
 #include "Action.hh"
+#include "ActionLog.hh"
 #include "Player.hh"
 #include "RiderGame.hh"
 #include "Hex.hh"
@@ -171,31 +172,37 @@ void Action::makeHypothetical () {
     source->setMirrorState(); 
     source = source->getMirror();
     assert(source);
+    source->touch(); // About to be changed, so undo must re-sync it.
   }
   if (target) {
     target->setMirrorState(); 
     target = target->getMirror();
     assert(target); 
+    target->touch();
   }
   if (start) {
     start->setMirrorState(); 
     start = start->getMirror();
     assert(start);
+    start->touch();
   }
   if (final) {
     final->setMirrorState(); 
     final = final->getMirror();
     assert(final);
+    final->touch();
   }
   if (begin) {
     begin->setMirrorState(); 
     begin = begin->getMirror();
     assert(begin);
+    begin->touch();
   }
   if (cease) {
     cease->setMirrorState(); 
     cease = cease->getMirror();
     assert(cease);
+    cease->touch();
   }
 }
 
@@ -305,9 +312,16 @@ void Action::undo () {
 
 Action::ActionResult Action::execute () {
   Action::ActionResult ret = checkPossible();
-  if (Ok != ret) return ret;
+  if (Ok != ret) {
+    result = Neutral;
+    if (print) ActionLog::record(*this, ret);
+    return ret;
+  }
 
-  Outcome result = Neutral; 
+  // Real actions draw from a reseeded stream so the outcome
+  // does not depend on how many hypotheticals the AI rolled first.
+  if (print) ActionLog::reseed();
+  result = Neutral; 
   if (todo.calc->die) {
     int dieroll = todo.calc->die->roll();
 
@@ -328,6 +342,7 @@ Action::ActionResult Action::execute () {
   
   if (NumOutcomes != force) result = force;
   ret = (this->*(todo.exec))(result);
+  if (print) ActionLog::record(*this, ret);
   return ret; 
 }
 
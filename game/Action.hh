@@ -22,6 +22,7 @@ extern const DieRoll OneDHun;
 
 struct Action {
   friend class StaticInitialiser; 
+  friend class ActionLog;
 public:
   enum ActionResult {Ok = 0, Fail, NotAdjacent, NotEnoughPops, AttackFails, WrongPlayer, Impassable, NoBuilding, NotImplemented}; 
   //enum Outcome {Disaster = 0, NoChange, Success, NumOutcomes};
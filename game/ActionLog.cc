@@ -0,0 +1,153 @@
+#include "ActionLog.hh"
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include "Hex.hh"
+#include "Player.hh"
+#include "game/MilUnit.hh"
+#include "Logger.hh"
+
+static const char logMagic[4] = {'C', 'A', 'L', 'G'};
+static const unsigned int logVersion = 1;
+
+unsigned int ActionLog::seed = 42;
+unsigned int ActionLog::step = 0;
+ofstream* ActionLog::writer = 0;
+ifstream* ActionLog::reader = 0;
+
+// Order is the on-disk encoding; append only.
+const Action::ThingsToDo* const ActionLog::allToDos[] = {&Action::EndTurn, &Action::Colonise, &Action::Attack, &Action::Mobilise,
+						     &Action::BuildFortress, &Action::Devastate, &Action::Reinforce,
+						     &Action::CallForSurrender, &Action::Recruit, &Action::Nothing, &Action::EnterGarrison};
+const unsigned int ActionLog::numToDos = sizeof(ActionLog::allToDos) / sizeof(ActionLog::allToDos[0]);
+
+template <class T> unsigned int iterableIndex (T* dat) {
+  unsigned int pos = dat->Iterable<T>::getSlot();
+  if (pos >= Iterable<T>::totalAmount()) throwFormatted("Object not found in iterable while writing action log");
+  return pos;
+}
+
+template <class T> T* iterableByIndex (unsigned int idx) {
+  if (idx >= Iterable<T>::totalAmount()) throwFormatted("Index %i out of range in action log", idx);
+  return *(Iterable<T>::start() + idx);
+}
+
+template <class T> void writeRaw (ofstream* out, T dat) {
+  out->write((const char*) &dat, sizeof(T));
+}
+
+template <class T> bool readRaw (ifstream* in, T& dat) {
+  in->read((char*) &dat, sizeof(T));
+  return in->good();
+}
+
+void ActionLog::newGame () {
+  step = 0;
+  srand(seed);
+}
+
+void ActionLog::reseed () {
+  srand(seed + 2654435761u * (++step));
+}
+
+void ActionLog::startRecording (string fname) {
+  stopRecording();
+  writer = new ofstream(fname.c_str(), ios::out | ios::binary | ios::trunc);
+  if (!writer->good()) {
+    Logger::logStream(Logger::Warning) << "Could not open action log " << fname << ", game will not be recorded.\n";
+    stopRecording();
+    return;
+  }
+  writer->write(logMagic, sizeof(logMagic));
+  writeRaw(writer, logVersion);
+  writeRaw(writer, seed);
+}
+
+void ActionLog::stopRecording () {
+  if (!writer) return;
+  writer->close();
+  delete writer;
+  writer = 0;
+}
+
+void ActionLog::record (const Action& act, Action::ActionResult res) {
+  if (!writer) return;
+  unsigned char todo = 0;
+  while ((todo < numToDos) && (act.todo.name != allToDos[todo]->name)) ++todo;
+  assert(todo < numToDos);
+
+  unsigned int ids[NumFields];
+  unsigned char mask = 0;
+  if (act.player)   {mask |= (1 << PlayerField);   ids[PlayerField]   = iterableIndex<Player>(act.player);}
+  if (act.source)   {mask |= (1 << SourceField);   ids[SourceField]   = iterableIndex<Hex>(act.source);}
+  if (act.target)   {mask |= (1 << TargetField);   ids[TargetField]   = iterableIndex<Hex>(act.target);}
+  if (act.start)    {mask |= (1 << StartField);    ids[StartField]    = iterableIndex<Vertex>(act.start);}
+  if (act.final)    {mask |= (1 << FinalField);    ids[FinalField]    = iterableIndex<Vertex>(act.final);}
+  if (act.begin)    {mask |= (1 << BeginField);    ids[BeginField]    = iterableIndex<Line>(act.begin);}
+  if (act.cease)    {mask |= (1 << CeaseField);    ids[CeaseField]    = iterableIndex<Line>(act.cease);}
+  if (act.unitType) {mask |= (1 << UnitTypeField); ids[UnitTypeField] = act.unitType->getIdx();}
+
+  writeRaw(writer, todo);
+  writeRaw(writer, (unsigned char) act.result);
+  writeRaw(writer, (unsigned char) res);
+  writeRaw(writer, mask);
+  for (int i = 0; i < NumFields; ++i) {
+    if (mask & (1 << i)) writeRaw(writer, ids[i]);
+  }
+  writer->flush();
+}
+
+bool ActionLog::openReplay (string fname) {
+  closeReplay();
+  reader = new ifstream(fname.c_str(), ios::in | ios::binary);
+  char magic[4];
+  unsigned int version = 0;
+  reader->read(magic, sizeof(magic));
+  if ((!reader->good()) || (!equal(magic, magic + 4, logMagic)) || (!readRaw(reader, version)) || (logVersion != version) || (!readRaw(reader, seed))) {
+    closeReplay();
+    return false;
+  }
+  return true;
+}
+
+bool ActionLog::readAction (Action& act, Action::ActionResult& res, Outcome& out) {
+  if (!reader) return false;
+  unsigned char todo = 0;
+  unsigned char outcome = 0;
+  unsigned char result = 0;
+  unsigned char mask = 0;
+  if (!readRaw(reader, todo)) return false;
+  if ((!readRaw(reader, outcome)) || (!readRaw(reader, result)) || (!readRaw(reader, mask))) throwFormatted("Truncated action record");
+  if (todo >= numToDos) throwFormatted("Unknown action type %i in action log", todo);
+  if (outcome >= NumOutcomes) throwFormatted("Unknown outcome %i in action log", outcome);
+
+  unsigned int ids[NumFields];
+  for (int i = 0; i < NumFields; ++i) {
+    if (!(mask & (1 << i))) continue;
+    if (!readRaw(reader, ids[i])) throwFormatted("Truncated action record");
+  }
+
+  act = Action();
+  act.todo = *allToDos[todo];
+  if (mask & (1 << PlayerField))   act.player   = iterableByIndex<Player>(ids[PlayerField]);
+  if (mask & (1 << SourceField))   act.source   = iterableByIndex<Hex>(ids[SourceField]);
+  if (mask & (1 << TargetField))   act.target   = iterableByIndex<Hex>(ids[TargetField]);
+  if (mask & (1 << StartField))    act.start    = iterableByIndex<Vertex>(ids[StartField]);
+  if (mask & (1 << FinalField))    act.final    = iterableByIndex<Vertex>(ids[FinalField]);
+  if (mask & (1 << BeginField))    act.begin    = iterableByIndex<Line>(ids[BeginField]);
+  if (mask & (1 << CeaseField))    act.cease    = iterableByIndex<Line>(ids[CeaseField]);
+  if (mask & (1 << UnitTypeField)) {
+    act.unitType = MilUnitTemplate::getByIndex(ids[UnitTypeField]);
+    if (!act.unitType) throwFormatted("Unknown unit type %i in action log", ids[UnitTypeField]);
+  }
+  res = (Action::ActionResult) result;
+  out = (Outcome) outcome;
+  return true;
+}
+
+void ActionLog::closeReplay () {
+  if (!reader) return;
+  reader->close();
+  delete reader;
+  reader = 0;
+}
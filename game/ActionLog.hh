@@ -0,0 +1,45 @@
+#ifndef ACTIONLOG_HH
+#define ACTIONLOG_HH
+
+#include <fstream>
+#include <string>
+#include "Action.hh"
+
+using namespace std;
+
+// Compact binary record of the real Actions taken in a game, from which
+// WarfareGame::replayGame can re-simulate the game given the scenario it
+// started from. Layout, native byte order:
+//   header: 'C' 'A' 'L' 'G', uint32 version, uint32 seed
+//   action: uint8 todo, uint8 outcome, uint8 result, uint8 fieldmask,
+//           then one uint32 index per field set in the mask.
+// Each real simulation step (executed Action or end of turn) reseeds the
+// RNG from the seed and a step counter, so neither AI evaluation nor
+// graphics initialisation can shift the random numbers the game sees.
+class ActionLog {
+public:
+  static void newGame ();
+  static void reseed ();
+  static unsigned int getSeed () {return seed;}
+  static void setSeed (unsigned int s) {seed = s;}
+
+  static void startRecording (string fname);
+  static void stopRecording ();
+  static void record (const Action& act, Action::ActionResult res);
+
+  static bool openReplay (string fname);
+  static bool readAction (Action& act, Action::ActionResult& res, Outcome& out);
+  static void closeReplay ();
+
+private:
+  enum Fields {PlayerField = 0, SourceField, TargetField, StartField, FinalField, BeginField, CeaseField, UnitTypeField, NumFields};
+
+  static const Action::ThingsToDo* const allToDos[];
+  static const unsigned int numToDos;
+  static unsigned int seed;
+  static unsigned int step;
+  static ofstream* writer;
+  static ifstream* reader;
+};
+
+#endif
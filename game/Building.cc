@@ -43,7 +43,6 @@ Castle::Castle (Hex* dat, Line* lin)
   , recruitType(0)
 {
   recruitType = *(MilUnitTemplate::start());
-  setMirrorState();
   support->getMarket()->registerParticipant(this);
 }
 
@@ -63,6 +62,7 @@ Castle::~Castle () {
 
 void Castle::addGarrison (MilUnit* p) {
   assert(p);
+  if (location) location->touch();
   garrison.push_back(p);
   p->setCastle(this);
   p->setLocation(0);
@@ -94,8 +94,8 @@ void Castle::endOfTurn () {
   distributeSupplies();
 }
 
-void Castle::getBids (const GoodsHolder& prices, vector<MarketBid*>& bidlist) {
-  vector<MarketBid*> unitBids;
+void Castle::getBids (const GoodsHolder& prices, BidSink& bidlist) {
+  BidSink unitBids;
   GoodsHolder allBids;
   orders.clear();
   double availableMoney = getAmount(TradeGood::Money);
@@ -104,10 +104,9 @@ void Castle::getBids (const GoodsHolder& prices, vector<MarketBid*>& bidlist) {
     mu->deliverGoods(TradeGood::Money, availableMoney);
     mu->getBids(prices, unitBids);
     mu->deliverGoods(TradeGood::Money, -availableMoney);
-    BOOST_FOREACH(MarketBid* mb, unitBids) {
-      orders[mu].deliverGoods(mb->tradeGood, mb->amountToBuy);
-      allBids.deliverGoods(mb->tradeGood, mb->amountToBuy);
-      delete mb;
+    BOOST_FOREACH(const MarketBid& mb, unitBids) {
+      orders[mu].deliverGoods(mb.tradeGood, mb.amountToBuy);
+      allBids.deliverGoods(mb.tradeGood, mb.amountToBuy);
     }
   }
   BOOST_FOREACH(MilUnit* mu, fieldForce) {
@@ -115,10 +114,9 @@ void Castle::getBids (const GoodsHolder& prices, vector<MarketBid*>& bidlist) {
     mu->deliverGoods(TradeGood::Money, availableMoney);
     mu->getBids(prices, unitBids);
     mu->deliverGoods(TradeGood::Money, -availableMoney);
-    BOOST_FOREACH(MarketBid* mb, unitBids) {
-      orders[mu].deliverGoods(mb->tradeGood, mb->amountToBuy);
-      allBids.deliverGoods(mb->tradeGood, mb->amountToBuy);
-      delete mb;
+    BOOST_FOREACH(const MarketBid& mb, unitBids) {
+      orders[mu].deliverGoods(mb.tradeGood, mb.amountToBuy);
+      allBids.deliverGoods(mb.tradeGood, mb.amountToBuy);
     }
   }
 
@@ -130,7 +128,7 @@ void Castle::getBids (const GoodsHolder& prices, vector<MarketBid*>& bidlist) {
   for (TradeGood::Iter tg = TradeGood::exLaborStart(); tg != TradeGood::final(); ++tg) {
     double amount = allBids.getAmount(*tg) * ratio - getAmount(*tg);
     if (0.01 > amount) continue;
-    bidlist.push_back(new MarketBid((*tg), amount, this, 1));
+    bidlist.addBid((*tg), amount, this, 1);
   }
 }
 
@@ -172,6 +170,7 @@ void Castle::distributeSupplies () {
 
 MilUnit* Castle::removeGarrison () {
   if (0 == garrison.size()) return 0;
+  if (location) location->touch();
   MilUnit* ret = garrison.back();
   garrison.pop_back();
   fieldForce.push_back(ret);
@@ -183,6 +182,7 @@ MilUnit* Castle::removeGarrison () {
 MilUnit* Castle::removeUnit (MilUnit* dat) {
   std::vector<MilUnit*>::iterator target = std::find(garrison.begin(), garrison.end(), dat);
   if (target == garrison.end()) return 0;
+  if (location) location->touch();
   MilUnit* ret = (*target);
   garrison.erase(target);
   ret->setCastle(0);
@@ -212,25 +212,25 @@ void Castle::unitTests () {
   testCastle->setAmount(TradeGood::Money, 1e6);
   GoodsHolder prices;
   for (TradeGood::Iter tg = TradeGood::exMoneyStart(); tg != TradeGood::final(); ++tg) prices.setAmount((*tg), 1);
-  vector<MarketBid*> bidlist;
+  BidSink bidlist;
   testCastle->getBids(prices, bidlist);
   if (0 == bidlist.size()) throwFormatted("Expected garrisoned Castle to make bids, got none");
 
   unsigned int initialUnits = TransportUnit::totalAmount();
-  BOOST_FOREACH(MarketBid* mb, bidlist) testCastle->deliverGoods(mb->tradeGood, mb->amountToBuy);
+  BOOST_FOREACH(const MarketBid& mb, bidlist) testCastle->deliverGoods(mb.tradeGood, mb.amountToBuy);
   testCastle->distributeSupplies();
-  BOOST_FOREACH(MarketBid* mb, bidlist) {
-    if (fabs(garrison->getAmount(mb->tradeGood) - mb->amountToBuy) > 0.01) throwFormatted("Expected garrison unit to get %.2f %s, but got %.2f",
-											  mb->amountToBuy,
-											  mb->tradeGood->getName().c_str(),
-											  garrison->getAmount(mb->tradeGood));
+  BOOST_FOREACH(const MarketBid& mb, bidlist) {
+    if (fabs(garrison->getAmount(mb.tradeGood) - mb.amountToBuy) > 0.01) throwFormatted("Expected garrison unit to get %.2f %s, but got %.2f",
+											  mb.amountToBuy,
+											  mb.tradeGood->getName().c_str(),
+											  garrison->getAmount(mb.tradeGood));
   }
 
   if (initialUnits != TransportUnit::totalAmount()) throwFormatted("Expected %i TransportUnits, found %i", initialUnits, TransportUnit::totalAmount());
   testCastle->removeGarrison();
   garrison->setLocation(testCastle->getLocation()->twoEnd());
   garrison->zeroGoods();
-  BOOST_FOREACH(MarketBid* mb, bidlist) testCastle->deliverGoods(mb->tradeGood, mb->amountToBuy);
+  BOOST_FOREACH(const MarketBid& mb, bidlist) testCastle->deliverGoods(mb.tradeGood, mb.amountToBuy);
   testCastle->distributeSupplies();
   if (initialUnits + 1 != TransportUnit::totalAmount()) throwFormatted("Expected Castle to create one TransportUnit, found %i", TransportUnit::totalAmount());
   TransportUnit::Iter tu = TransportUnit::start();
@@ -239,11 +239,11 @@ void Castle::unitTests () {
   if (initialUnits != TransportUnit::totalAmount()) throwFormatted("Expected TransportUnit to reach destination and destroy itself, %i -> %i",
 								   initialUnits,
 								   TransportUnit::totalAmount());
-  BOOST_FOREACH(MarketBid* mb, bidlist) {
-    if (fabs(garrison->getAmount(mb->tradeGood) - mb->amountToBuy) > 0.01) throwFormatted("Expected field unit to get %.2f %s, but got %.2f (%i -> %i)",
-											  mb->amountToBuy,
-											  mb->tradeGood->getName().c_str(),
-											  garrison->getAmount(mb->tradeGood),
+  BOOST_FOREACH(const MarketBid& mb, bidlist) {
+    if (fabs(garrison->getAmount(mb.tradeGood) - mb.amountToBuy) > 0.01) throwFormatted("Expected field unit to get %.2f %s, but got %.2f (%i -> %i)",
+											  mb.amountToBuy,
+											  mb.tradeGood->getName().c_str(),
+											  garrison->getAmount(mb.tradeGood),
 											  initialUnits,
 											  TransportUnit::totalAmount());
   }
@@ -267,25 +267,25 @@ void Castle::receiveTaxes (TradeGood const* const tg, double received) {
 
 void Castle::setOwner (Player* p) {
   Building::setOwner(p);
-  if (isReal()) mirror->setOwner(p);
+  if (isReal()) GraphicsInfo::sceneChanged();
   for (vector<MilUnit*>::iterator u = garrison.begin(); u != garrison.end(); ++u) {
     (*u)->setOwner(p);
   }
 }
 
 void Castle::setMirrorState () {
-  mirror->setOwner(getOwner());
-  mirror->support = support;
-  mirror->location = location;
-  mirror->recruitType = recruitType;
+  getMirror()->setOwner(getOwner());
+  getMirror()->support = support;
+  getMirror()->location = location->getMirror();
+  getMirror()->recruitType = recruitType;
 
-  mirror->garrison.clear();
+  getMirror()->garrison.clear();
   for (std::vector<MilUnit*>::iterator unt = garrison.begin(); unt != garrison.end(); ++unt) {
     (*unt)->setMirrorState();
-    mirror->garrison.push_back((*unt)->getMirror());
+    getMirror()->garrison.push_back((*unt)->getMirror());
   }
-  mirror->setAmounts(this);
-  setEconMirrorState(mirror);
+  getMirror()->setAmounts(this);
+  setEconMirrorState(getMirror());
 }
 
 Village::Village ()
@@ -329,7 +329,7 @@ void Village::MaslowLevel::normalise () {
   }
 }
 
-void Village::getBids (const GoodsHolder& prices, vector<MarketBid*>& bidlist) {
+void Village::getBids (const GoodsHolder& prices, BidSink& bidlist) {
   // For each level in the Maslow hierarchy,
   // see if we can sell enough labor to cover it
   // (at the given prices). Then put in a sell bid
@@ -429,7 +429,7 @@ void Village::getBids (const GoodsHolder& prices, vector<MarketBid*>& bidlist) {
 
   for (TradeGood::Iter tg = TradeGood::exMoneyStart(); tg != TradeGood::final(); ++tg) {
     if (0.1 > fabs(totalToBuy.getAmount(*tg))) continue;
-    bidlist.push_back(new MarketBid((*tg), totalToBuy.getAmount(*tg), this));
+    bidlist.addBid((*tg), totalToBuy.getAmount(*tg), this);
   }
 }
 
@@ -443,17 +443,21 @@ void Village::unitTests () {
   Hex* testHex = Hex::getTestHex(true, false, false, false);
   Village* testVillage = testHex->getVillage();
   GoodsHolder prices;
-  vector<MarketBid*> bidlist;
+  BidSink bidlist;
   prices.deliverGoods(TradeGood::Labor, 1);
   for (TradeGood::Iter tg = TradeGood::exLaborStart(); tg != TradeGood::final(); ++tg) {
     prices.deliverGoods((*tg), 0.25);
   }
   testVillage->getBids(prices, bidlist);
   if (0 == bidlist.size()) throw string("Village should have made at least one bid.");
-  BOOST_FOREACH(MarketBid* mb, bidlist) {
-    if ((mb->tradeGood == TradeGood::Labor) && (mb->amountToBuy > 0)) throw string("Should be selling, not buying, labor.");
-    else if ((mb->tradeGood != TradeGood::Labor) && (mb->amountToBuy < 0)) throw string("Should be buying, not selling, ") + mb->tradeGood->getName();
+  BOOST_FOREACH(const MarketBid& mb, bidlist) {
+    if ((mb.tradeGood == TradeGood::Labor) && (mb.amountToBuy > 0)) throw string("Should be selling, not buying, labor.");
+    else if ((mb.tradeGood != TradeGood::Labor) && (mb.amountToBuy < 0)) throw string("Should be buying, not selling, ") + mb.tradeGood->getName();
   }
+  vector<MarketBid*> bidPointers;
+  testVillage->getBids(prices, bidPointers);
+  if (bidPointers.size() != bidlist.size()) throwFormatted("Expected %i bids through the pointer-list getBids, got %i", (int) bidlist.size(), (int) bidPointers.size());
+  BOOST_FOREACH(MarketBid* mb, bidPointers) delete mb;
 
   double labor = testVillage->produceForContract(TradeGood::Labor, 100);
   if (fabs(labor - 100) > 0.1) {
@@ -484,7 +488,7 @@ void Village::unitTests () {
   testVillage->getBids(prices, bidlist);
   if (2 != bidlist.size()) throwFormatted("Line %i: Expected 2 bids, got %i, reason %s", __LINE__, bidlist.size(), testVillage->stopReason.c_str());
   GoodsHolder theBids;
-  BOOST_FOREACH(MarketBid* mb, bidlist) theBids.deliverGoods(mb->tradeGood, mb->amountToBuy);
+  BOOST_FOREACH(const MarketBid& mb, bidlist) theBids.deliverGoods(mb.tradeGood, mb.amountToBuy);
   // Minus one from selling
   double labourExpected = -1 * (maslowLevels[0]->getAmount(TradeGood::Money) * testVillage->consumption() * prices.getAmount(theGood)) / prices.getAmount(TradeGood::Labor);
   double labourBought = theBids.getAmount(TradeGood::Labor);
@@ -508,7 +512,7 @@ void Village::unitTests () {
   testVillage->getBids(prices, bidlist);
   if (2 != bidlist.size()) throwFormatted("Line %i: Expected 2 bids, got %i, reason %s", __LINE__, bidlist.size(), testVillage->stopReason.c_str());
   labourBought = 0;
-  BOOST_FOREACH(MarketBid* mb, bidlist) if (mb->tradeGood == TradeGood::Labor) labourBought += mb->amountToBuy;
+  BOOST_FOREACH(const MarketBid& mb, bidlist) if (mb.tradeGood == TradeGood::Labor) labourBought += mb.amountToBuy;
   labourExpected = -1 * ((maslowLevels[0]->getAmount(TradeGood::Money) + maslowLevels[1]->getAmount(TradeGood::Money)) * testVillage->consumption() * prices.getAmount(theGood)) / prices.getAmount(TradeGood::Labor);
   if (0.001 < fabs(labourExpected - labourBought)) throwFormatted("Line %i: Expected to buy %f labour, but bought %f, reason %s",
 								  __LINE__,
@@ -527,7 +531,7 @@ void Village::unitTests () {
   testVillage->getBids(prices, bidlist);
   if (3 != bidlist.size()) throwFormatted("Line %i: Expected 3 bids, got %i, reason %s", __LINE__, bidlist.size(), testVillage->stopReason.c_str());
   theBids.zeroGoods();
-  BOOST_FOREACH(MarketBid* mb, bidlist) theBids.deliverGoods(mb->tradeGood, mb->amountToBuy);
+  BOOST_FOREACH(const MarketBid& mb, bidlist) theBids.deliverGoods(mb.tradeGood, mb.amountToBuy);
   double woodExpected = testVillage->consumption();
   woodExpected *= pow(prices.getAmount(theGood) / maslowLevels[0]->getAmount(theGood), maslowLevels[0]->getAmount(theGood));
   woodExpected *= pow(prices.getAmount(nextGood) / maslowLevels[0]->getAmount(nextGood), maslowLevels[0]->getAmount(nextGood));
@@ -594,6 +598,37 @@ void Village::unitTests () {
 												 labourContract.amount,
 												 testVillage->getAmount(TradeGood::Labor));
 
+  MilUnitTemplate const* militiaType = MilUnit::getTestType();
+  testVillage->increaseTradition(militiaType);
+  testVillage->increaseTradition(militiaType);
+  int malesBefore = testVillage->males.getTotalPopulation();
+  MilUnit* estimate = testVillage->estimateMilitia();
+  int expectedMen = min(2*militiaType->recruit_speed, malesBefore);
+  if (estimate->totalSoldiers() != expectedMen) throwFormatted("Expected militia estimate of %i men, got %i",
+							       expectedMen,
+							       estimate->totalSoldiers());
+  if (malesBefore != testVillage->males.getTotalPopulation()) throwFormatted("Estimating militia should not recruit from the village");
+  if ((!estimate->isReal()) || (estimate->getReal() != estimate)) throwFormatted("Militia estimate should be its own real unit, not a mirror of the militia");
+  if (2 != testVillage->getMilitiaStrength(militiaType)) throwFormatted("Estimating militia should not increase the tradition");
+  testVillage->increaseTradition(militiaType);
+  estimate = testVillage->estimateMilitia();
+  expectedMen = min(3*militiaType->recruit_speed, malesBefore);
+  if (estimate->totalSoldiers() != expectedMen) throwFormatted("Expected militia estimate to follow tradition to %i men, got %i",
+							       expectedMen,
+							       estimate->totalSoldiers());
+  testVillage->males.clear();
+  testVillage->males.addPop(1, 20);
+  testVillage->milTrad->invalidateEstimate();
+  estimate = testVillage->estimateMilitia();
+  if (1 != estimate->totalSoldiers()) throwFormatted("Expected militia estimate capped at 1 man, got %i", estimate->totalSoldiers());
+  AgeTracker standing;
+  standing.addPop(5, 20);
+  testVillage->getMilitia()->addElement(militiaType, standing);
+  testVillage->milTrad->invalidateEstimate();
+  estimate = testVillage->estimateMilitia();
+  if (6 != estimate->totalSoldiers()) throwFormatted("Expected militia estimate to include standing militia for 6 men, got %i", estimate->totalSoldiers());
+  delete testVillage;
+
   maslowLevels = backupLevels;
 }
 
@@ -609,22 +644,54 @@ const MilUnitGraphicsInfo* Village::getMilitiaGraphics () const {
 
 MilitiaTradition::MilitiaTradition ()
   : Mirrorable<MilitiaTradition>()
+  , estimate(0)
+  , estimateValid(false)
+  , drillLevel(0)
 {
   militia = new MilUnit();
-  setMirrorState();
 }
 
 MilitiaTradition::~MilitiaTradition () {
-  militia->destroyIfReal();
+  if (militia) militia->destroyIfReal();
+  if (estimate) delete estimate;
 }
 
 MilitiaTradition::MilitiaTradition (MilitiaTradition* other)
   : Mirrorable<MilitiaTradition>(other)
+  , militia(0)
+  , estimate(0)
+  , estimateValid(false)
+  , drillLevel(0)
 {}
 
+MilUnit* MilitiaTradition::getEstimate (int availableMen) {
+  if (estimateValid) return estimate;
+  if (!estimate) estimate = militia->createEstimate();
+  AgeTracker discard;
+  estimate->demobilise(discard);
+  // Each regiment of tradition raises at most recruit_speed men, and
+  // Village::produceRecruits stops when the village runs out of men.
+  // Raised men join the militia already standing. Age does not affect
+  // fighting strength.
+  AgeTracker recruits;
+  int unrecruited = availableMen;
+  for (map<MilUnitTemplate const* const, int>::iterator i = militiaStrength.begin(); i != militiaStrength.end(); ++i) {
+    int men = min(getUnitTypeAmount((*i).first), unrecruited);
+    if (0 < men) unrecruited -= men;
+    men += militia->getUnitTypeAmount((*i).first);
+    if (1 > men) continue;
+    recruits.clear();
+    recruits.addPop(men, 20);
+    estimate->addElement((*i).first, recruits);
+  }
+  estimateValid = true;
+  return estimate;
+}
+
 void MilitiaTradition::increaseTradition (MilUnitTemplate const* target) {
   if (!target) target = getKeyByWeight<MilUnitTemplate const* const>(militiaStrength);
   if (target) militiaStrength[target]++;
+  estimateValid = false;
 }
 
 void MilitiaTradition::decayTradition () {
@@ -632,6 +699,7 @@ void MilitiaTradition::decayTradition () {
     int loss = convertFractionToInt((*i).second * (*i).first->militiaDecay * MilUnitTemplate::getDrillEffect(drillLevel));
     militiaStrength[(*i).first] -= loss;
   }
+  estimateValid = false;
 }
 
 double MilitiaTradition::getRequiredWork () {
@@ -658,12 +726,14 @@ string MilitiaTradition::display () const {
 
 void MilitiaTradition::setMirrorState () {
   militia->setMirrorState();
-  mirror->militia = militia->getMirror();
-  mirror->militiaStrength.clear();
+  getMirror()->militia = militia->getMirror();
+  getMirror()->estimateValid = false;
+  if ((getMirror()->militiaStrength == militiaStrength) && (getMirror()->drillLevel == drillLevel)) return;
+  getMirror()->militiaStrength.clear();
   for (map<MilUnitTemplate const* const, int>::iterator i = militiaStrength.begin(); i != militiaStrength.end(); ++i) {
-    mirror->militiaStrength[(*i).first] = (*i).second;
+    getMirror()->militiaStrength[(*i).first] = (*i).second;
   }
-  mirror->drillLevel = drillLevel;
+  getMirror()->drillLevel = drillLevel;
 }
 
 
@@ -747,6 +817,7 @@ void Village::endOfTurn () {
 
   males.addPop((int) floor(0.5 * popIncrease + 0.5), 0);
   women.addPop((int) floor(0.5 * popIncrease + 0.5), 0);
+  milTrad->invalidateEstimate();
   updateMaxPop();
   if ((isReal()) && (getGraphicsInfo())) {
     getGraphicsInfo()->addEvent(DisplayEvent(createString("%i births, %i deaths", popIncrease, deaths), ""));
@@ -772,6 +843,7 @@ void Village::endOfTurn () {
 void Village::demobMilitia () {
   if (!milTrad) return;
   milTrad->militia->demobilise(males);
+  milTrad->invalidateEstimate();
 }
 
 MilUnit* Village::raiseMilitia () {
@@ -782,6 +854,7 @@ MilUnit* Village::raiseMilitia () {
   }
 
   milTrad->increaseTradition();
+  milTrad->invalidateEstimate();
   return milTrad->militia;
 }
 
@@ -819,10 +892,10 @@ Farmer::Farmer (Farmer* other)
 {}
 
 void Farmer::setMirrorState () {
-  for (unsigned int i = 0; i < fields.size(); ++i) mirror->fields[i] = fields[i];
-  setEconMirrorState(mirror);
-  mirror->extraLabour = extraLabour;
-  mirror->totalWorked = totalWorked;
+  for (unsigned int i = 0; i < fields.size(); ++i) getMirror()->fields[i] = fields[i];
+  setEconMirrorState(getMirror());
+  getMirror()->extraLabour = extraLabour;
+  getMirror()->totalWorked = totalWorked;
 }
 
 Farmer::~Farmer () {}
@@ -929,7 +1002,7 @@ void Farmer::unitTests () {
   deliverGoods(testCapGood, -1);
 
   GoodsHolder prices;
-  vector<MarketBid*> bidlist;
+  BidSink bidlist;
   double foundLabour  = 0;
   double foundCapGood = 0;
   double foundOutput  = 0;
@@ -939,8 +1012,8 @@ void Farmer::unitTests () {
   prices.setAmount(testCapGood, 100000);
   prices.setAmount(output, 100000);
   getBids(prices, bidlist);
-  BOOST_FOREACH(MarketBid* mb, bidlist) {
-    if (mb->tradeGood == TradeGood::Labor) foundLabour += mb->amountToBuy;
+  BOOST_FOREACH(const MarketBid& mb, bidlist) {
+    if (mb.tradeGood == TradeGood::Labor) foundLabour += mb.amountToBuy;
   }
   double springLabour = 0;
   FieldStatus::Iter fs = FieldStatus::startPlow();
@@ -965,19 +1038,19 @@ void Farmer::unitTests () {
   getBids(prices, bidlist);
 
   foundLabour = 0;
-  BOOST_FOREACH(MarketBid* mb, bidlist) {
-    if (mb->tradeGood == TradeGood::Labor) foundLabour += mb->amountToBuy;
-    else if (mb->tradeGood == testCapGood) foundCapGood += mb->amountToBuy;
-    else if (mb->tradeGood == output) foundOutput += mb->amountToBuy;
+  BOOST_FOREACH(const MarketBid& mb, bidlist) {
+    if (mb.tradeGood == TradeGood::Labor) foundLabour += mb.amountToBuy;
+    else if (mb.tradeGood == testCapGood) foundCapGood += mb.amountToBuy;
+    else if (mb.tradeGood == output) foundOutput += mb.amountToBuy;
     else throwFormatted("Expected to bid on %s and %s and to sell %s, but got bid for %f %s (capital %f price %f) %i %i %f",
 			TradeGood::Labor->getName().c_str(),
 			testCapGood->getName().c_str(),
 			output->getName().c_str(),
-			mb->amountToBuy,
-			mb->tradeGood->getName().c_str(),
-			capital->getAmount(mb->tradeGood),
-			prices.getAmount(mb->tradeGood),
-			mb->tradeGood->getIdx(),
+			mb.amountToBuy,
+			mb.tradeGood->getName().c_str(),
+			capital->getAmount(mb.tradeGood),
+			prices.getAmount(mb.tradeGood),
+			mb.tradeGood->getIdx(),
 			testCapGood->getIdx(),
 			capital->getAmount(testCapGood));
   }
@@ -994,10 +1067,10 @@ void Farmer::unitTests () {
   double secondFoundOutput = 0;
   foundLabour = 0;
   foundCapGood = 0;
-  BOOST_FOREACH(MarketBid* mb, bidlist) {
-    if (mb->tradeGood == TradeGood::Labor) foundLabour += mb->amountToBuy;
-    else if (mb->tradeGood == testCapGood) foundCapGood += mb->amountToBuy;
-    else if (mb->tradeGood == output) foundOutput += mb->amountToBuy;
+  BOOST_FOREACH(const MarketBid& mb, bidlist) {
+    if (mb.tradeGood == TradeGood::Labor) foundLabour += mb.amountToBuy;
+    else if (mb.tradeGood == testCapGood) foundCapGood += mb.amountToBuy;
+    else if (mb.tradeGood == output) foundOutput += mb.amountToBuy;
   }
   if (foundLabour <= 0) throwFormatted("Expected (again) to buy %s, found %.2f", TradeGood::Labor->getName().c_str(), foundLabour);
   if (foundCapGood <= 0) throwFormatted("Expected (again) to buy %s, found %.2f", testCapGood->getName().c_str(), foundCapGood);
@@ -1418,10 +1491,10 @@ Forester::Forester (Forester* other)
 {}
 
 void Forester::setMirrorState () {
-  for (unsigned int i = 0; i < fields.size(); ++i) mirror->fields[i] = fields[i];
-  mirror->tendedGroves = tendedGroves;
-  mirror->wildForest = wildForest;
-  setEconMirrorState(mirror);
+  for (unsigned int i = 0; i < fields.size(); ++i) getMirror()->fields[i] = fields[i];
+  getMirror()->tendedGroves = tendedGroves;
+  getMirror()->wildForest = wildForest;
+  setEconMirrorState(getMirror());
 }
 
 Forester::~Forester () {}
@@ -1492,7 +1565,7 @@ void Forester::unitTests () {
   blockInfo->workableBlocks = 200;
   createBlockQueue();
   GoodsHolder prices;
-  vector<MarketBid*> bidlist;
+  BidSink bidlist;
   zeroGoods();
   if (0 < getAmount(testCapGood)) throwFormatted("Expected not to have any more capital after clearing; found %f %i", getAmount(testCapGood), testCapGood->getIdx());
   prices.deliverGoods(TradeGood::Labor, 1);
@@ -1502,23 +1575,23 @@ void Forester::unitTests () {
 
   double foundLabour = 0;
   bool foundCapGood = false;
-  BOOST_FOREACH(MarketBid* mb, bidlist) {
-    if (mb->tradeGood == TradeGood::Labor) {
-      foundLabour += mb->amountToBuy;
+  BOOST_FOREACH(const MarketBid& mb, bidlist) {
+    if (mb.tradeGood == TradeGood::Labor) {
+      foundLabour += mb.amountToBuy;
     }
-    else if (mb->tradeGood == testCapGood) {
+    else if (mb.tradeGood == testCapGood) {
       foundCapGood = true;
-      if (mb->amountToBuy <= 0) throwFormatted("Expected to buy %s, but am selling", testCapGood->getName().c_str());
+      if (mb.amountToBuy <= 0) throwFormatted("Expected to buy %s, but am selling", testCapGood->getName().c_str());
     }
     else {
       throwFormatted("Expected to bid on %s and %s, but got bid for %f %s (capital %f price %f) %i %i %f",
 		     TradeGood::Labor->getName().c_str(),
 		     testCapGood->getName().c_str(),
-		     mb->amountToBuy,
-		     mb->tradeGood->getName().c_str(),
-		     capital->getAmount(mb->tradeGood),
-		     prices.getAmount(mb->tradeGood),
-		     mb->tradeGood->getIdx(),
+		     mb.amountToBuy,
+		     mb.tradeGood->getName().c_str(),
+		     capital->getAmount(mb.tradeGood),
+		     prices.getAmount(mb.tradeGood),
+		     mb.tradeGood->getIdx(),
 		     testCapGood->getIdx(),
 		     capital->getAmount(testCapGood));
     }
@@ -1739,35 +1812,35 @@ void Forester::createBlockQueue () {
 }
 
 void Forest::setMirrorState () {
-  mirror->setOwner(getOwner());
-  mirror->workers.clear();
+  getMirror()->setOwner(getOwner());
+  getMirror()->workers.clear();
   BOOST_FOREACH(Forester* forester, workers) {
     forester->setMirrorState();
-    mirror->workers.push_back(forester->getMirror());
+    getMirror()->workers.push_back(forester->getMirror());
   }
-  mirror->yearsSinceLastTick = yearsSinceLastTick;
+  getMirror()->yearsSinceLastTick = yearsSinceLastTick;
 }
 
 void Village::setMirrorState () {
   women.setMirrorState();
   males.setMirrorState();
   milTrad->setMirrorState();
-  mirror->milTrad = milTrad->getMirror();
-  mirror->consumptionLevel = consumptionLevel;
-  mirror->setOwner(getOwner());
+  getMirror()->milTrad = milTrad->getMirror();
+  getMirror()->consumptionLevel = consumptionLevel;
+  getMirror()->setOwner(getOwner());
   // Building mirror states set by Hex.
-  if (farm) mirror->farm = farm->getMirror();
-  setEconMirrorState(mirror);
+  if (farm) getMirror()->farm = farm->getMirror();
+  setEconMirrorState(getMirror());
 }
 
 void Farmland::setMirrorState () {
-  mirror->setOwner(getOwner());
-  mirror->workers.clear();
+  getMirror()->setOwner(getOwner());
+  getMirror()->workers.clear();
   BOOST_FOREACH(Farmer* farmer, workers) {
     farmer->setMirrorState();
-    mirror->workers.push_back(farmer->getMirror());
+    getMirror()->workers.push_back(farmer->getMirror());
   }
-  mirror->blockSize = blockSize;
+  getMirror()->blockSize = blockSize;
 }
 
 double Village::production () const {
@@ -1987,8 +2060,8 @@ int Miner::numBlocks () const {
 }
 
 void Miner::setMirrorState () {
-  for (unsigned int i = 0; i < fields.size(); ++i) mirror->fields[i] = fields[i];
-  setEconMirrorState(mirror);
+  for (unsigned int i = 0; i < fields.size(); ++i) getMirror()->fields[i] = fields[i];
+  setEconMirrorState(getMirror());
 }
 
 Miner::~Miner () {}
@@ -2096,7 +2169,7 @@ void Miner::unitTests () {
 
   getLabourForBlock(0, jobs, laborNeeded);
   GoodsHolder prices;
-  vector<MarketBid*> bidlist;
+  BidSink bidlist;
   prices.deliverGoods(TradeGood::Labor, 1);
   prices.deliverGoods(testCapGood, 1);
   prices.deliverGoods(output, 1);
@@ -2104,13 +2177,13 @@ void Miner::unitTests () {
 
   double foundLabour = 0;
   bool foundCapGood = false;
-  BOOST_FOREACH(MarketBid* mb, bidlist) {
-    if (mb->tradeGood == TradeGood::Labor) {
-      foundLabour += mb->amountToBuy;
+  BOOST_FOREACH(const MarketBid& mb, bidlist) {
+    if (mb.tradeGood == TradeGood::Labor) {
+      foundLabour += mb.amountToBuy;
     }
-    else if (mb->tradeGood == testCapGood) {
+    else if (mb.tradeGood == testCapGood) {
       foundCapGood = true;
-      if (mb->amountToBuy <= 0) {
+      if (mb.amountToBuy <= 0) {
 	sprintf(errorMessage, "Expected to buy %s, but am selling", testCapGood->getName().c_str());
 	throw string(errorMessage);
       }
@@ -2120,11 +2193,11 @@ void Miner::unitTests () {
 	      "Expected to bid on %s and %s, but got bid for %f %s (capital %f price %f) %i %i %f",
 	      TradeGood::Labor->getName().c_str(),
 	      testCapGood->getName().c_str(),
-	      mb->amountToBuy,
-	      mb->tradeGood->getName().c_str(),
-	      capital->getAmount(mb->tradeGood),
-	      prices.getAmount(mb->tradeGood),
-	      mb->tradeGood->getIdx(),
+	      mb.amountToBuy,
+	      mb.tradeGood->getName().c_str(),
+	      capital->getAmount(mb.tradeGood),
+	      prices.getAmount(mb.tradeGood),
+	      mb.tradeGood->getIdx(),
 	      testCapGood->getIdx(),
 	      capital->getAmount(testCapGood));
       throw string(errorMessage);
@@ -2158,8 +2231,8 @@ void Miner::unitTests () {
   bidlist.clear();
   getBids(prices, bidlist);
   double newFoundLabour = 0;
-  BOOST_FOREACH(MarketBid* mb, bidlist) {
-    if (mb->tradeGood == TradeGood::Labor) newFoundLabour += mb->amountToBuy;
+  BOOST_FOREACH(const MarketBid& mb, bidlist) {
+    if (mb.tradeGood == TradeGood::Labor) newFoundLabour += mb.amountToBuy;
   }
   if (fabs(foundLabour - newFoundLabour) > 0.1) throwFormatted("With zero margin, expected to buy %f, but got %f",
 							       foundLabour,
@@ -2170,8 +2243,8 @@ void Miner::unitTests () {
   bidlist.clear();
   getBids(prices, bidlist);
   newFoundLabour = 0;
-  BOOST_FOREACH(MarketBid* mb, bidlist) {
-    if (mb->tradeGood == TradeGood::Labor) newFoundLabour += mb->amountToBuy;
+  BOOST_FOREACH(const MarketBid& mb, bidlist) {
+    if (mb.tradeGood == TradeGood::Labor) newFoundLabour += mb.amountToBuy;
   }
   if (fabs(blockInfo->workableBlocks*foundLabour - newFoundLabour) > 0.1) throwFormatted("With margin 1, expected to buy %f, but got %f",
 										   blockInfo->workableBlocks*foundLabour,
@@ -2249,11 +2322,11 @@ void Miner::extractResources (bool /*tick*/) {
 }
 
 void Mine::setMirrorState () {
-  mirror->setOwner(getOwner());
-  mirror->workers.clear();
+  getMirror()->setOwner(getOwner());
+  getMirror()->workers.clear();
   BOOST_FOREACH(Miner* miner, workers) {
     miner->setMirrorState();
-    mirror->workers.push_back(miner->getMirror());
+    getMirror()->workers.push_back(miner->getMirror());
   }
 }
 
@@ -53,7 +53,8 @@ template <class T> class Industry : public EconActor {
 public:
   Industry (T* ind, BlockInfo* bi) : EconActor(), blockInfo(bi), industry(ind) {}
   
-  virtual void getBids (const GoodsHolder& prices, vector<MarketBid*>& bidlist) {
+  using EconActor::getBids;
+  virtual void getBids (const GoodsHolder& prices, BidSink& bidlist) {
     // Goal is to maximise profit. Calculate how much labor we need to get in the harvest;
     // if the price of the expected food is more, bid for enough labor to do this turn's work.
     // If there is money left over, bid for equipment to reduce the amount of labor needed
@@ -110,8 +111,8 @@ public:
 	neededPerTurn -= reserveLabour;
 	reserveLabour -= chunksPerTurn * perChunk;
       }
-      if (1 == turns) bidlist.push_back(new MarketBid(TradeGood::Labor, neededPerTurn, this, 1));
-      else bidlist.push_back(new MarketBid(TradeGood::Labor, neededPerTurn, this, turns-1));
+      if (1 == turns) bidlist.addBid(TradeGood::Labor, neededPerTurn, this, 1);
+      else bidlist.addBid(TradeGood::Labor, neededPerTurn, this, turns-1);
     }
 
     double winterLabour = industry->getWinterLabour(prices, lastBlock, totalExpectedProduction, fullCycleLabour);
@@ -123,7 +124,7 @@ public:
       winterLabour -= reserveLabour;
       reserveLabour = 0;
     }
-    if (0 < winterLabour) bidlist.push_back(new MarketBid(TradeGood::Labor, winterLabour, this, 1));
+    if (0 < winterLabour) bidlist.addBid(TradeGood::Labor, winterLabour, this, 1);
 
     for (TradeGood::Iter tg = TradeGood::exLaborStart(); tg != TradeGood::final(); ++tg) {
       if (capital->getAmount(*tg) < 0.00001) continue;
@@ -131,7 +132,7 @@ public:
       // Assuming discount rate of 10%. Present value of amount x every period to infinity is (x/r) with r the interest rate.
       // TODO: Take decay into account. Variable discount rate?
       double npv = laborSaving * prices.getAmount(TradeGood::Labor) * 10;
-      if (npv > prices.getAmount(*tg) * industry->getCapitalSize()) bidlist.push_back(new MarketBid((*tg), industry->getCapitalSize(), this, 1));
+      if (npv > prices.getAmount(*tg) * industry->getCapitalSize()) bidlist.addBid((*tg), industry->getCapitalSize(), this, 1);
     }
 
     // Decide how much output to sell. On average, sell the inverse
@@ -151,7 +152,7 @@ public:
     fractionToSell -= soldThisTurn.getAmount(output);
     fractionToSell -= promisedToDeliver.getAmount(output);
     if (1 > fractionToSell) return;
-    bidlist.push_back(new MarketBid(output, -1 * min(fractionToSell, getAmount(output)), this, 1));
+    bidlist.addBid(output, -1 * min(fractionToSell, getAmount(output)), this, 1);
   }
   
   double capitalFactor (const GoodsHolder& capitalToUse) const {
@@ -223,7 +224,8 @@ public:
   void addGarrison (MilUnit* p);
   void callForSurrender (MilUnit* siegers, Outcome out); 
   virtual void endOfTurn ();
-  virtual void getBids (const GoodsHolder& prices, vector<MarketBid*>& bidlist);
+  using EconActor::getBids;
+  virtual void getBids (const GoodsHolder& prices, BidSink& bidlist);
   Line* getLocation () const {return location;}
   MilUnit* getGarrison (unsigned int i) {if (i >= garrison.size()) return 0; return garrison[i];}
   Hex* getSupport () {return support;}
@@ -272,14 +274,21 @@ public:
   double getRequiredWork (); 
   virtual void setMirrorState ();
   int getDrill () {return drillLevel;}
+  // The militia that raising would produce from availableMen, without
+  // recruiting anyone or growing the tradition. Kept until the tradition
+  // changes or the owner calls invalidateEstimate.
+  MilUnit* getEstimate (int availableMen);
+  void invalidateEstimate () {estimateValid = false;}
   int getStrength (MilUnitTemplate const* const dat) {return militiaStrength[dat];}
-  void increaseDrill (bool up) {drillLevel += up ? 1 : -1;} 
+  void increaseDrill (bool up) {drillLevel += up ? 1 : -1; estimateValid = false;} 
   virtual int getUnitTypeAmount (MilUnitTemplate const* const ut) const;  // Slightly distinct from 'getStrength' in returning numbers of men, not regiments. 
   
 private:
   MilitiaTradition (MilitiaTradition* other); 
   
   MilUnit* militia;
+  MilUnit* estimate;
+  bool estimateValid;
   map<MilUnitTemplate const* const, int> militiaStrength;
   int drillLevel;
 };
@@ -295,13 +304,15 @@ public:
   double consumption () const;
   void demobMilitia ();
   virtual void endOfTurn ();
-  virtual void getBids (const GoodsHolder& prices, vector<MarketBid*>& bidlist);
+  using EconActor::getBids;
+  virtual void getBids (const GoodsHolder& prices, BidSink& bidlist);
   double getFractionOfMaxPop () const {double ret = getTotalPopulation(); ret /= maxPopulation; return min(1.0, ret);}
   const MilUnitGraphicsInfo* getMilitiaGraphics () const; 
   int getTotalPopulation () const {return males.getTotalPopulation() + women.getTotalPopulation();}
   // Returns unit pointer without the side effects of mobilising.
   MilUnit* getMilitia () const {return milTrad->militia;}
   MilUnit* raiseMilitia ();
+  MilUnit* estimateMilitia () {return milTrad ? milTrad->getEstimate(males.getTotalPopulation()) : 0;}
   MilitiaTradition* getMilitiaTradition () {return milTrad;}
   virtual double produceForContract (TradeGood const* const tg, double amount);
   virtual double produceForTaxes (TradeGood const* const tg, double amount, ContractInfo::AmountType taxType);
@@ -5,24 +5,114 @@
 #include "Logger.hh" 
 #include <cassert>
 #include <algorithm> 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 TradeGood const* TradeGood::Money = 0;
 TradeGood const* TradeGood::Labor = 0;
 
+// Arithmetic kernels over contiguous goods arrays. Two lanes at a
+// time where SSE2 is available; the tail, or everything, otherwise.
+static inline void addGoods (double* dst, const double* src, unsigned int n, double sign) {
+  unsigned int i = 0;
+#ifdef __SSE2__
+  __m128d s = _mm_set1_pd(sign);
+  for (; i + 2 <= n; i += 2) {
+    _mm_storeu_pd(dst + i, _mm_add_pd(_mm_loadu_pd(dst + i), _mm_mul_pd(s, _mm_loadu_pd(src + i))));
+  }
+#endif
+  for (; i < n; ++i) dst[i] += sign * src[i];
+}
+
+static inline void scaleGoods (double* dst, unsigned int n, double scale) {
+  unsigned int i = 0;
+#ifdef __SSE2__
+  __m128d s = _mm_set1_pd(scale);
+  for (; i + 2 <= n; i += 2) {
+    _mm_storeu_pd(dst + i, _mm_mul_pd(_mm_loadu_pd(dst + i), s));
+  }
+#endif
+  for (; i < n; ++i) dst[i] *= scale;
+}
+
+static inline double dotGoods (const double* one, const double* two, unsigned int n) {
+  unsigned int i = 0;
+  double ret = 0;
+#ifdef __SSE2__
+  __m128d acc = _mm_setzero_pd();
+  for (; i + 2 <= n; i += 2) {
+    acc = _mm_add_pd(acc, _mm_mul_pd(_mm_loadu_pd(one + i), _mm_loadu_pd(two + i)));
+  }
+  double lanes[2];
+  _mm_storeu_pd(lanes, acc);
+  ret = lanes[0] + lanes[1];
+#endif
+  for (; i < n; ++i) ret += one[i] * two[i];
+  return ret;
+}
+
 GoodsHolder::GoodsHolder ()
-  : tradeGoods(TradeGood::numTypes(), 0)
-{}
+  : tradeGoods(inlineGoods)
+  , numGoods(0)
+{
+  allocate(TradeGood::numTypes());
+  zeroGoods();
+}
 
 GoodsHolder::GoodsHolder (const GoodsHolder& other)
-  : tradeGoods(TradeGood::numTypes(), 0)
+  : tradeGoods(inlineGoods)
+  , numGoods(0)
 {
+  allocate(TradeGood::numTypes());
+  zeroGoods();
   setAmounts(other);
 }
 
+GoodsHolder::GoodsHolder (GoodsHolder&& other)
+  : tradeGoods(inlineGoods)
+  , numGoods(0)
+{
+  *this = std::move(other);
+}
+
+GoodsHolder::~GoodsHolder () {
+  release();
+}
+
+GoodsHolder& GoodsHolder::operator= (const GoodsHolder& other) {
+  if (this == &other) return *this;
+  allocate(other.numGoods);
+  copy(other.tradeGoods, other.tradeGoods + numGoods, tradeGoods);
+  return *this;
+}
+
+GoodsHolder& GoodsHolder::operator= (GoodsHolder&& other) {
+  if (this == &other) return *this;
+  if (other.isInline()) return (*this = static_cast<const GoodsHolder&>(other));
+  release();
+  tradeGoods = other.tradeGoods;
+  numGoods = other.numGoods;
+  other.tradeGoods = other.inlineGoods;
+  other.numGoods = 0;
+  return *this;
+}
+
+void GoodsHolder::allocate (unsigned int n) {
+  if (n == numGoods) return;
+  release();
+  if (n > GOODS_INLINE_CAPACITY) tradeGoods = new double[n];
+  numGoods = n;
+}
+
+void GoodsHolder::release () {
+  if (!isInline()) delete[] tradeGoods;
+  tradeGoods = inlineGoods;
+  numGoods = 0;
+}
+
 void GoodsHolder::deliverGoods (const GoodsHolder& gh) {
-  for (TradeGood::Iter tg = TradeGood::start(); tg != TradeGood::final(); ++tg) {
-    tradeGoods[**tg] += gh.getAmount(*tg);
-  }
+  addGoods(tradeGoods, gh.tradeGoods, min(numGoods, gh.numGoods), 1);
 }
 
 string GoodsHolder::display (int indent) const {
@@ -41,39 +131,29 @@ GoodsHolder GoodsHolder::loot (double lootRatio) {
 }
 
 void GoodsHolder::setAmounts (GoodsHolder const* const gh) {
-  for (TradeGood::Iter tg = TradeGood::start(); tg != TradeGood::final(); ++tg) {
-    tradeGoods[**tg] = gh->getAmount(*tg);
-  }
+  setAmounts(*gh);
 }
 
 void GoodsHolder::setAmounts (const GoodsHolder& gh) {
-  for (TradeGood::Iter tg = TradeGood::start(); tg != TradeGood::final(); ++tg) {
-    tradeGoods[**tg] = gh.getAmount(*tg);
-  }
+  if (this == &gh) return;
+  unsigned int n = min(numGoods, gh.numGoods);
+  copy(gh.tradeGoods, gh.tradeGoods + n, tradeGoods);
 }
 
 void GoodsHolder::zeroGoods () {
-  for (TradeGood::Iter tg = TradeGood::start(); tg != TradeGood::final(); ++tg) {
-    tradeGoods[**tg] = 0;
-  }
+  fill(tradeGoods, tradeGoods + numGoods, 0.0);
 }
 
 void GoodsHolder::operator+= (const GoodsHolder& other) {
-  for (TradeGood::Iter tg = TradeGood::start(); tg != TradeGood::final(); ++tg) {
-    tradeGoods[**tg] += other.tradeGoods[**tg];
-  }
+  addGoods(tradeGoods, other.tradeGoods, min(numGoods, other.numGoods), 1);
 }
 
 void GoodsHolder::operator-= (const GoodsHolder& other) {
-  for (TradeGood::Iter tg = TradeGood::start(); tg != TradeGood::final(); ++tg) {
-    tradeGoods[**tg] -= other.tradeGoods[**tg];
-  }
+  addGoods(tradeGoods, other.tradeGoods, min(numGoods, other.numGoods), -1);
 }
 
 void GoodsHolder::operator*= (const double scale) {
-  for (TradeGood::Iter tg = TradeGood::start(); tg != TradeGood::final(); ++tg) {
-    tradeGoods[**tg] *= scale;
-  }
+  scaleGoods(tradeGoods, numGoods, scale);
 }
 
 GoodsHolder operator* (const GoodsHolder& gh, const double scale) {
@@ -89,11 +169,7 @@ GoodsHolder operator* (const double scale, const GoodsHolder& gh) {
 }
 
 double operator* (const GoodsHolder& gh1, const GoodsHolder& gh2) {
-  double ret = 0;
-  for (TradeGood::Iter tg = TradeGood::start(); tg != TradeGood::final(); ++tg) {
-    ret += gh1.getAmount(*tg) * gh2.getAmount(*tg);
-  }
-  return ret;
+  return dotGoods(gh1.tradeGoods, gh2.tradeGoods, min(gh1.numGoods, gh2.numGoods));
 }
 
 EconActor::EconActor ()
@@ -111,6 +187,12 @@ EconActor::~EconActor () {
   leaveMarket();
 }
 
+void EconActor::getBids (const GoodsHolder& prices, vector<MarketBid*>& bidlist) {
+  BidSink sink;
+  getBids(prices, sink);
+  BOOST_FOREACH(const MarketBid& mb, sink) bidlist.push_back(new MarketBid(mb));
+}
+
 void EconActor::consume (TradeGood const* const tg, double amount) {
   double amountActuallyUsed = amount * tg->getConsumption();
   deliverGoods(tg, -amountActuallyUsed);
@@ -240,4 +322,22 @@ void EconActor::unitTests () {
   for (TradeGood::Iter tg = TradeGood::exMoneyStart(); tg != TradeGood::final(); ++tg) {
     if ((*tg) == TradeGood::Money) throw string("exMoneyStart iterator should have skipped money.");
   }
+
+  GoodsHolder one;
+  GoodsHolder two;
+  double expectedDot = 0;
+  for (TradeGood::Iter tg = TradeGood::start(); tg != TradeGood::final(); ++tg) {
+    one.setAmount((*tg), 1 + (*tg)->getIdx());
+    two.setAmount((*tg), 2);
+    expectedDot += 2 * (1 + (*tg)->getIdx());
+  }
+  if (fabs(one * two - expectedDot) > 0.0001) throwFormatted("Expected dot product %f, got %f", expectedDot, one * two);
+  GoodsHolder sum(one);
+  sum += two;
+  sum -= one;
+  GoodsHolder scaled = 0.5 * sum;
+  GoodsHolder moved(std::move(scaled));
+  for (TradeGood::Iter tg = TradeGood::start(); tg != TradeGood::final(); ++tg) {
+    if (fabs(moved.getAmount(*tg) - 1) > 0.0001) throwFormatted("Expected 1 %s after arithmetic, got %f", (*tg)->getName().c_str(), moved.getAmount(*tg));
+  }
 }
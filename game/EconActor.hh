@@ -12,6 +12,7 @@ using namespace std;
 class EconActor;
 class Market;
 class MarketBid;
+class BidSink;
 class MarketContract;
 
 class TradeGood : public Enumerable<const TradeGood> {
@@ -37,16 +38,27 @@ private:
   double capital;      // Amount lost when used for capital.
 }; 
 
+// Holders with at most this many goods keep them inline, avoiding
+// a heap allocation for every temporary; larger goods lists spill.
+#ifndef GOODS_INLINE_CAPACITY
+#define GOODS_INLINE_CAPACITY 12
+#endif
+
 struct GoodsHolder {
 public:
   GoodsHolder ();
   GoodsHolder (const GoodsHolder& other);
+  GoodsHolder (GoodsHolder&& other);
+  ~GoodsHolder ();
+  GoodsHolder& operator= (const GoodsHolder& other);
+  GoodsHolder& operator= (GoodsHolder&& other);
   double       getAmount    (unsigned int idx) const {return tradeGoods[idx];}
   double       getAmount    (TradeGood const* const tg) const {return tradeGoods[*tg];}
   void         deliverGoods (TradeGood const* const tg, double amount) {tradeGoods[*tg] += amount;}
   void         deliverGoods (const GoodsHolder& gh);
   string       display      (int indent = 0) const;
   GoodsHolder  loot         (double lootRatio);
+  void         setAmount    (unsigned int idx, double amount) {tradeGoods[idx] = amount;}
   void         setAmount    (TradeGood const* const tg, double amount) {tradeGoods[*tg] = amount;}
   void         setAmounts   (GoodsHolder const* const gh);
   void         setAmounts   (const GoodsHolder& gh);
@@ -55,8 +67,16 @@ public:
   void operator-= (const GoodsHolder& other);
   void operator+= (const GoodsHolder& other);
   void operator*= (const double scale);
+
+  friend double operator* (const GoodsHolder& gh1, const GoodsHolder& gh2);
 private:
-  vector<double> tradeGoods;
+  void allocate (unsigned int n);
+  void release ();
+  bool isInline () const {return tradeGoods == inlineGoods;}
+
+  double* tradeGoods;
+  unsigned int numGoods;
+  double inlineGoods[GOODS_INLINE_CAPACITY];
 };
 
 GoodsHolder operator* (const GoodsHolder& gh, const double scale);
@@ -110,7 +130,9 @@ public:
   void setEconMirror (EconActor* ea) {econMirror = ea;}
   void unregisterContract (MarketContract const* const contract);
   
-  virtual void getBids (const GoodsHolder& /*prices*/, vector<MarketBid*>& /*bidlist*/) {}
+  virtual void getBids (const GoodsHolder& /*prices*/, BidSink& /*bidlist*/) {}
+  // Pointer-list adaptor for the above; the caller owns the bids.
+  void getBids (const GoodsHolder& prices, vector<MarketBid*>& bidlist);
   static void clear () {Numbered<EconActor>::clear();}
   static void unitTests ();
 
@@ -24,6 +24,8 @@ Vertex::Vertex ()
   , groupNum(0)
   , graphicsInfo(0)
   , theMarket(0)
+  , namePos(0, 0)
+  , nameDirection(NoVertex)
 {
   neighbours.resize(NoVertex);
 }
@@ -35,10 +37,18 @@ Vertex::Vertex (Vertex* other)
   , groupNum(other->groupNum)
   , graphicsInfo(0)
   , theMarket(0)
+  , namePos(0, 0)
+  , nameDirection(NoVertex)
 {
   neighbours.resize(NoVertex);
 }
 
+string Vertex::generateName (Vertex const* dat) {
+  pair<int, int> pos = dat->namePos;
+  sprintf(stringbuffer, "[%i, %i, %s%s]", pos.first, pos.second, getVertexName(dat->nameDirection).c_str(), dat->isMirror() ? " (M)" : "");
+  return stringbuffer;
+}
+
 Vertex::~Vertex () {
   for (std::vector<MilUnit*>::iterator u = units.begin(); u != units.end(); ++u) {
     (*u)->destroyIfReal();
@@ -68,11 +78,11 @@ Hex::Hex (int x, int y, TerrainType t)
 {
   initialise();
 
-  mirror->pos.first = x;
-  mirror->pos.second = y;
-  mirror->myType = myType;
-  mirror->owner = owner;
-  mirror->initialise();
+  getMirror()->pos.first = x;
+  getMirror()->pos.second = y;
+  getMirror()->myType = myType;
+  getMirror()->owner = owner;
+  getMirror()->initialise();
 }
 
 Hex::Hex (Hex* other)
@@ -193,7 +203,7 @@ std::pair<int, int> Hex::getPos (Direction dat) const {
 void Hex::setNeighbour (Direction d, Hex* dat) {
   if (!dat) return; 
   neighbours[d] = dat;
-  if (real == this) mirror->setNeighbour(d, dat->getMirror()); 
+  if (real == this) getMirror()->setNeighbour(d, dat->getMirror()); 
 }
 
 void Hex::createVertices () {
@@ -228,34 +238,33 @@ void Hex::createVertices () {
     vertices[i]->hexes.push_back(this); 
   }
 
-  vertices[LeftUp]->neighbours[Right] = vertices[RightUp]; vertices[LeftUp]->mirror->neighbours[Right] = vertices[RightUp]->mirror; 
-  vertices[RightUp]->neighbours[Left] = vertices[LeftUp]; vertices[RightUp]->mirror->neighbours[Left] = vertices[LeftUp]->mirror;
+  vertices[LeftUp]->neighbours[Right] = vertices[RightUp]; vertices[LeftUp]->getMirror()->neighbours[Right] = vertices[RightUp]->getMirror(); 
+  vertices[RightUp]->neighbours[Left] = vertices[LeftUp]; vertices[RightUp]->getMirror()->neighbours[Left] = vertices[LeftUp]->getMirror();
   
-  vertices[RightUp]->neighbours[RightDown] = vertices[Right]; vertices[RightUp]->mirror->neighbours[RightDown] = vertices[Right]->mirror;
-  vertices[Right]->neighbours[LeftUp] = vertices[RightUp]; vertices[Right]->mirror->neighbours[LeftUp] = vertices[RightUp]->mirror;
+  vertices[RightUp]->neighbours[RightDown] = vertices[Right]; vertices[RightUp]->getMirror()->neighbours[RightDown] = vertices[Right]->getMirror();
+  vertices[Right]->neighbours[LeftUp] = vertices[RightUp]; vertices[Right]->getMirror()->neighbours[LeftUp] = vertices[RightUp]->getMirror();
   
-  vertices[Right]->neighbours[LeftDown] = vertices[RightDown]; vertices[Right]->mirror->neighbours[LeftDown] = vertices[RightDown]->mirror;
-  vertices[RightDown]->neighbours[RightUp] = vertices[Right]; vertices[RightDown]->mirror->neighbours[RightUp] = vertices[Right]->mirror;
+  vertices[Right]->neighbours[LeftDown] = vertices[RightDown]; vertices[Right]->getMirror()->neighbours[LeftDown] = vertices[RightDown]->getMirror();
+  vertices[RightDown]->neighbours[RightUp] = vertices[Right]; vertices[RightDown]->getMirror()->neighbours[RightUp] = vertices[Right]->getMirror();
   
-  vertices[RightDown]->neighbours[Left] = vertices[LeftDown]; vertices[RightDown]->mirror->neighbours[Left] = vertices[LeftDown]->mirror;
-  vertices[LeftDown]->neighbours[Right] = vertices[RightDown]; vertices[LeftDown]->mirror->neighbours[Right] = vertices[RightDown]->mirror;
+  vertices[RightDown]->neighbours[Left] = vertices[LeftDown]; vertices[RightDown]->getMirror()->neighbours[Left] = vertices[LeftDown]->getMirror();
+  vertices[LeftDown]->neighbours[Right] = vertices[RightDown]; vertices[LeftDown]->getMirror()->neighbours[Right] = vertices[RightDown]->getMirror();
   
-  vertices[LeftDown]->neighbours[LeftUp] = vertices[Left]; vertices[LeftDown]->mirror->neighbours[LeftUp] = vertices[Left]->mirror;
-  vertices[Left]->neighbours[RightDown] = vertices[LeftDown]; vertices[Left]->mirror->neighbours[RightDown] = vertices[LeftDown]->mirror;
+  vertices[LeftDown]->neighbours[LeftUp] = vertices[Left]; vertices[LeftDown]->getMirror()->neighbours[LeftUp] = vertices[Left]->getMirror();
+  vertices[Left]->neighbours[RightDown] = vertices[LeftDown]; vertices[Left]->getMirror()->neighbours[RightDown] = vertices[LeftDown]->getMirror();
   
-  vertices[Left]->neighbours[RightUp] = vertices[LeftUp]; vertices[Left]->mirror->neighbours[RightUp] = vertices[LeftUp]->mirror;
-  vertices[LeftUp]->neighbours[LeftDown] = vertices[Left]; vertices[LeftUp]->mirror->neighbours[LeftDown] = vertices[Left]->mirror;
+  vertices[Left]->neighbours[RightUp] = vertices[LeftUp]; vertices[Left]->getMirror()->neighbours[RightUp] = vertices[LeftUp]->getMirror();
+  vertices[LeftUp]->neighbours[LeftDown] = vertices[Left]; vertices[LeftUp]->getMirror()->neighbours[LeftDown] = vertices[Left]->getMirror();
   
   for (int i = 0; i < NoVertex; ++i) {
-    if (vertices[i]->getName() != "ToBeNamed") continue;
-    sprintf(stringbuffer, "[%i, %i, %s]", pos.first, pos.second, getVertexName(convertToVertex(i)).c_str());
-    vertices[i]->setName(stringbuffer);
-    sprintf(stringbuffer, "[%i, %i, %s (M)]", pos.first, pos.second, getVertexName(convertToVertex(i)).c_str());
-    vertices[i]->getMirror()->setName(stringbuffer);
+    if (vertices[i]->isNamed()) continue;
+    vertices[i]->namePos = pos;
+    vertices[i]->nameDirection = convertToVertex(i);
+    vertices[i]->setNameGenerator(&Vertex::generateName);
   }
 
   for (int i = 0; i < NoVertex; ++i) {
-    mirror->vertices[i] = vertices[i]->getMirror(); 
+    getMirror()->vertices[i] = vertices[i]->getMirror(); 
   }
 }
 
@@ -290,14 +299,13 @@ void Hex::setVillage (Village* f) {
 } 
 
 void Hex::setLine (Direction dir, Line* l) {
-  if (l->getName() == "ToBeNamed") {
-    sprintf(stringbuffer, "{%i, %i, %s}", pos.first, pos.second, getDirectionName(dir).c_str()); 
-    l->setName(stringbuffer);
-    sprintf(stringbuffer, "{%i, %i, %s (M)}", pos.first, pos.second, getDirectionName(dir).c_str()); 
-    l->getMirror()->setName(stringbuffer);
+  if (!l->isNamed()) {
+    l->namePos = pos;
+    l->nameDirection = dir;
+    l->setNameGenerator(&Line::generateName);
   }
   lines[dir] = l;
-  if (real == this) mirror->setLine(dir, l->getMirror());
+  if (real == this) getMirror()->setLine(dir, l->getMirror());
 }
 
 void Vertex::createLines () {
@@ -316,10 +324,10 @@ void Vertex::createLines () {
     
     Line* line = new Line(this, (*vex), hex1, hex2);
     lines.push_back(line);
-    mirror->lines.push_back(line->getMirror());
+    getMirror()->lines.push_back(line->getMirror());
     assert(*vex);
     (*vex)->lines.push_back(line);
-    if ((*vex)->mirror) (*vex)->mirror->lines.push_back(line->getMirror()); 
+    (*vex)->getMirror()->lines.push_back(line->getMirror());
 
     switch (hex1->getDirection(this)) {
     case Right:
@@ -522,9 +530,13 @@ Vertices Vertex::getDirection (Vertex const * const ofdis) const {
 
 void Hex::setOwner (Player* p) {
   owner = p;
+  touch();
+  if (isReal()) GraphicsInfo::sceneChanged();
 }
 
 void Vertex::addUnit (MilUnit* dat) {
+  touch();
+  if (isReal()) GraphicsInfo::sceneChanged();
   units.push_back(dat);
   dat->setLocation(this); 
 }
@@ -566,14 +578,16 @@ Line::Line (Vertex* one, Vertex* two, Hex* hone, Hex* thwo)
   , hex2(thwo)
   , castle(0)
   , graphicsInfo(0)
+  , namePos(0, 0)
+  , nameDirection(NoDirection)
 {
   assert(vex1);
   assert(vex2);
   assert(hex1);
-  mirror->vex1 = vex1->getMirror();
-  mirror->vex2 = vex2->getMirror();
-  mirror->hex1 = hex1->getMirror();
-  if (hex2) mirror->hex2 = hex2->getMirror();
+  getMirror()->vex1 = vex1->getMirror();
+  getMirror()->vex2 = vex2->getMirror();
+  getMirror()->hex1 = hex1->getMirror();
+  if (hex2) getMirror()->hex2 = hex2->getMirror();
 }
 
 // Mirror constructor
@@ -587,8 +601,16 @@ Line::Line (Line* other)
   , hex2(0)
   , castle(0)
   , graphicsInfo(0)
+  , namePos(0, 0)
+  , nameDirection(NoDirection)
 {}
 
+string Line::generateName (Line const* dat) {
+  pair<int, int> pos = dat->namePos;
+  sprintf(stringbuffer, "{%i, %i, %s%s}", pos.first, pos.second, getDirectionName(dat->nameDirection).c_str(), dat->isMirror() ? " (M)" : "");
+  return stringbuffer;
+}
+
 Line::~Line () {
   if (castle) castle->destroyIfReal();
   delete graphicsInfo;
@@ -619,73 +641,117 @@ void Vertex::forceRetreat (Castle*& c, Vertex*& v) {
 }
 
 void Line::addCastle (Castle* dat) {
+  touch();
   castle = dat;
+  if (isReal()) GraphicsInfo::sceneChanged();
 }
 
 void Line::setMirrorState () {
-  assert(mirror);
+  if (mirrorIsCurrent()) return;
+  if ((NoDirection != nameDirection) && (!getMirror()->isNamed())) {
+    getMirror()->namePos = namePos;
+    getMirror()->nameDirection = nameDirection;
+    getMirror()->setNameGenerator(&Line::generateName);
+  }
   if (castle) {
     castle->setMirrorState();
-    mirror->castle = castle->getMirror();
+    getMirror()->castle = castle->getMirror();
   }
   else {
-    if (mirror->castle) delete mirror->castle->getReal(); 
-    mirror->castle = 0; 
+    if (getMirror()->castle) delete getMirror()->castle->getReal(); 
+    getMirror()->castle = 0; 
   }
+  markMirrored();
 }
 
 void Vertex::setMirrorState () {
-  mirror->units.clear();
+  if (mirrorIsCurrent()) return;
+  if ((NoVertex != nameDirection) && (!getMirror()->isNamed())) {
+    getMirror()->namePos = namePos;
+    getMirror()->nameDirection = nameDirection;
+    getMirror()->setNameGenerator(&Vertex::generateName);
+  }
+  getMirror()->units.clear();
   if (0 < numUnits()) {
     units[0]->setMirrorState();
-    mirror->units.push_back(units[0]->getMirror());
+    getMirror()->units.push_back(units[0]->getMirror());
   }
-  if (theMarket) mirror->theMarket = theMarket->getMirror();
-  else mirror->theMarket = 0;
+  if (theMarket) getMirror()->theMarket = theMarket->getMirror();
+  else getMirror()->theMarket = 0;
+  markMirrored();
 }
 
 void Hex::setMirrorState () {
-  mirror->owner = owner;
+  if (mirrorIsCurrent()) return;
+  getMirror()->owner = owner;
   if (farms) {
     farms->setMirrorState();
-    mirror->farms = farms->getMirror();
+    getMirror()->farms = farms->getMirror();
   }
   else {
-    if (mirror->farms) delete mirror->farms->getReal(); 
-    mirror->farms = 0; 
+    if (getMirror()->farms) delete getMirror()->farms->getReal(); 
+    getMirror()->farms = 0; 
   }
   if (village) {
     village->setMirrorState();
-    mirror->village = village->getMirror();
+    getMirror()->village = village->getMirror();
   }
   else {
-    if (mirror->village) delete mirror->village->getReal(); 
-    mirror->village = 0; 
+    if (getMirror()->village) delete getMirror()->village->getReal(); 
+    getMirror()->village = 0; 
   }
   if (forest) {
     forest->setMirrorState();
-    mirror->forest = forest->getMirror();
+    getMirror()->forest = forest->getMirror();
   }
   else {
-    if (mirror->forest) delete mirror->forest->getReal();
-    mirror->forest = 0;
+    if (getMirror()->forest) delete getMirror()->forest->getReal();
+    getMirror()->forest = 0;
   }
   if (mine) {
     mine->setMirrorState();
-    mirror->mine = mine->getMirror();
+    getMirror()->mine = mine->getMirror();
   }
   else {
-    if (mirror->mine) delete mirror->mine->getReal();
-    mirror->mine = 0;
-  }
-  if (castle) mirror->castle = castle->getMirror();
-  else mirror->castle = 0;
-
-  mirror->marketVtx = marketVtx->getMirror();
+    if (getMirror()->mine) delete getMirror()->mine->getReal();
+    getMirror()->mine = 0;
+  }
+  if (castle) getMirror()->castle = castle->getMirror();
+  else getMirror()->castle = 0;
+
+  getMirror()->marketVtx = marketVtx->getMirror();
+  markMirrored();
+}
+
+void Hex::unitTests () {
+  // Vertex and Line names are generated on demand; check that doing so
+  // registers them for lookup.
+  Hex* testHex = getTestHex(false, false, false, false);
+  Vertex* testVertex = *(testHex->vexBegin());
+  if (!testVertex->isNamed()) throw string("Vertex should have a name generator");
+  string vertexName = testVertex->getName();
+  if (Vertex::getByName(vertexName) != testVertex) throwFormatted("Could not find vertex %s by name", vertexName.c_str());
+  testVertex->setMirrorState(); // Mirrors get their name generator when first synced.
+  string mirrorName = testVertex->getMirror()->getName();
+  if (mirrorName == vertexName) throwFormatted("Mirror of %s has the same name", vertexName.c_str());
+  if (Vertex::getByName(mirrorName) != testVertex->getMirror()) throwFormatted("Could not find vertex %s by name", mirrorName.c_str());
+
+  if (testVertex->beginLines() == testVertex->endLines()) throw string("Test vertex should have lines");
+  Line* testLine = *(testVertex->beginLines());
+  string lineName = testLine->getName();
+  if (Line::getByName(lineName) != testLine) throwFormatted("Could not find line %s by name", lineName.c_str());
+
+  // Vertices outlive the hex that described them, so a name asked for
+  // afterwards must not need it.
+  Vertex* laterVertex = *(testHex->vexBegin() + 1);
+  pair<int, int> pos = testHex->getPos();
+  delete testHex;
+  sprintf(stringbuffer, "[%i, %i, ", pos.first, pos.second);
+  string expectedStart = stringbuffer;
+  string laterName = laterVertex->getName();
+  if (0 != laterName.find(expectedStart)) throwFormatted("Expected vertex name starting %s, got %s", expectedStart.c_str(), laterName.c_str());
 }
 
-void Hex::unitTests () {}
-
 bool Hex::colonise (Line* lin, MilUnit* unit, Outcome out) {
   // Sanity checks 
   if (!unit) return false;
@@ -107,7 +107,7 @@ public:
   typedef vector<Hex*>::iterator HexIterator;
   typedef vector<MilUnit*>::iterator UnitIterator;
 
-  MilUnit* removeUnit () {MilUnit* ret = units.back(); units.pop_back(); return ret;}
+  MilUnit* removeUnit () {touch(); if (isReal()) GraphicsInfo::sceneChanged(); MilUnit* ret = units.back(); units.pop_back(); return ret;}
   void addUnit (MilUnit* dat);
   int numUnits () const {return units.size();}
   MilUnit* getUnit (int i) {if (i >= (int) units.size()) return 0; if (i < 0) return 0; return units[i];}
@@ -188,11 +188,16 @@ private:
   VertexGraphicsInfo* graphicsInfo;
   doublet position;
   Market* theMarket;
+  pair<int, int> namePos;   // Hex position and corner that generateName describes.
+  Vertices nameDirection;
+
+  static string generateName (Vertex const* dat);
 };
 
 class Line : public Mirrorable<Line>, public Named<Line>, public Iterable<Line> {
   friend class Mirrorable<Line>;
   friend class StaticInitialiser;
+  friend class Hex;
 public:
   Line (Vertex* one, Vertex* two, Hex* hone, Hex* thwo);
   ~Line ();
@@ -223,6 +228,10 @@ private:
   Castle* castle;
   LineGraphicsInfo* graphicsInfo;
   doublet position;
+  pair<int, int> namePos;   // Hex position and side that generateName describes.
+  Direction nameDirection;
+
+  static string generateName (Line const* dat);
 };
 
 #endif
@@ -2,6 +2,17 @@
 #include "boost/range/algorithm/remove_if.hpp"
 #include "boost/bind.hpp"
 
+ObjectPool<MarketContract> MarketContract::pool;
+
+void* MarketContract::operator new (size_t size) {
+  assert(sizeof(MarketContract) == size);
+  return pool.allocate();
+}
+
+void MarketContract::operator delete (void* dat) {
+  pool.release(dat);
+}
+
 void MarketContract::clear () {
   cashPaid = 0;
   delivered = 0;
@@ -114,14 +125,13 @@ void Market::holdMarket () {
   consumed.zeroGoods();
   produced.zeroGoods();
   BOOST_FOREACH(EconActor* ea, participants) ea->clearRecord();
-  vector<MarketBid*> bidlist;
-  vector<MarketBid*> notMatched;
+  BidSink bidlist;
+  BidSink notMatched;
   BOOST_FOREACH(EconActor* ea, participants) ea->getBids(prices, bidlist);
   makeContracts(bidlist, notMatched);
   executeContracts();
   adjustPrices(notMatched);
   normalisePrices();
-  BOOST_FOREACH(MarketBid* mb, notMatched) delete mb;
   BOOST_FOREACH(EconActor* ea, participants) ea->dunAndPay();
   vector<MarketContract*>::iterator new_end = remove_if(contracts, !bind(&MarketContract::isValid, _1));
   for (vector<MarketContract*>::iterator i = new_end; i != contracts.end(); ++i) delete (*i);
@@ -139,41 +149,34 @@ void Market::holdMarket () {
   }
 }
 
-void Market::makeContracts (vector<MarketBid*>& bids, vector<MarketBid*>& notMatched) {
+void Market::makeContracts (BidSink& bidSink, BidSink& notMatched) {
   // Match buyers and sellers to create Contracts.
+  vector<MarketBid>& bids = bidSink.buffer;
   while (bids.size()) {
-    MarketBid* toMatch = bids.back();
-    if (!toMatch) throw string("Popped null bid");
-    if (!toMatch->bidder) throw string ("Bid with null bidder");
-    if (!toMatch->tradeGood) throw string ("Bid with no trade good");
+    MarketBid toMatch = bids.back();
+    if (!toMatch.bidder) throw string ("Bid with null bidder");
+    if (!toMatch.tradeGood) throw string ("Bid with no trade good");
     bids.pop_back();
-    MarketBid* match = 0;
-    BOOST_FOREACH(MarketBid* mb, bids) {
+    vector<MarketBid>::iterator match = bids.begin();
+    for (; match != bids.end(); ++match) {
       // Search for a bid with the same good, but opposite sign.
-      if (mb->tradeGood != toMatch->tradeGood) continue;
-      if (mb->amountToBuy * toMatch->amountToBuy > 0) continue;      
-      if (mb->bidder == toMatch->bidder) throwFormatted("Bidder %i trying to buy and sell %s at the same time", mb->bidder->getIdx(), mb->tradeGood->getName().c_str());
-      if (mb == toMatch) throw string("Bid appears twice in bid list");
-      match = mb;
+      if (match->tradeGood != toMatch.tradeGood) continue;
+      if (match->amountToBuy * toMatch.amountToBuy > 0) continue;
+      if (match->bidder == toMatch.bidder) throwFormatted("Bidder %i trying to buy and sell %s at the same time", match->bidder->getIdx(), match->tradeGood->getName().c_str());
       break;
     }
-    if (!match) {
-      notMatched.push_back(toMatch);
+    if (match == bids.end()) {
+      notMatched.buffer.push_back(toMatch);
       continue;
     }
-    REMOVE(bids, match);
-    if (fabs(toMatch->amountToBuy) < fabs(match->amountToBuy)) {
-      MarketBid* temp = toMatch;
-      toMatch = match;
-      match = temp;
-    }
+    MarketBid other = (*match);
+    bids.erase(match);
+    if (fabs(toMatch.amountToBuy) < fabs(other.amountToBuy)) swap(toMatch, other);
 
-    MarketContract* contract = new MarketContract(toMatch, match, prices.getAmount(toMatch->tradeGood), min(toMatch->duration, match->duration));
+    MarketContract* contract = new MarketContract(&toMatch, &other, prices.getAmount(toMatch.tradeGood), min(toMatch.duration, other.duration));
     contracts.push_back(contract);
-    toMatch->amountToBuy += match->amountToBuy;
-    delete match;
-    if (fabs(toMatch->amountToBuy) < 0.1) delete toMatch;
-    else bids.push_back(toMatch);
+    toMatch.amountToBuy += other.amountToBuy;
+    if (fabs(toMatch.amountToBuy) >= 0.1) bids.push_back(toMatch);
   }
 }
 
@@ -184,30 +187,33 @@ void Market::normalisePrices () {
   }
 }
 
-void Market::adjustPrices (vector<MarketBid*>& notMatched) {
+void Market::adjustPrices (const BidSink& notMatched) {
   // Count up leftover bids in each good and adjust price
   // upwards if there are leftover buyers, downwards if there
   // are leftover sellers.
 
   demand.zeroGoods();
-  for (TradeGood::Iter tg = TradeGood::exMoneyStart(); tg != TradeGood::final(); ++tg) {
-    BOOST_FOREACH(MarketBid* mb, notMatched) {
-      if (mb->tradeGood != (*tg)) continue;
-      demand.deliverGoods((*tg), mb->amountToBuy);
-    }
-    double currentVolume = volume.getAmount(*tg);
-    if (currentVolume < 1) currentVolume = 1;
-    double ratio = fabs(demand.getAmount(*tg));
-    if (ratio * 10000 < currentVolume) continue;
-    ratio /= currentVolume;
+  BOOST_FOREACH(const MarketBid& mb, notMatched) demand.deliverGoods(mb.tradeGood, mb.amountToBuy);
+  demand.setAmount(TradeGood::Money, 0);
+
+  GoodsHolder downwards;
+  for (TradeGood::Iter tg = TradeGood::start(); tg != TradeGood::final(); ++tg) {
+    downwards.setAmount((*tg), (*tg)->getStickiness() - 1);
+  }
 
+  // Branch-free over goods so the compiler can vectorise it; goods with
+  // negligible excess demand (including Money, zeroed above) get a zero step.
+  unsigned int numGoods = TradeGood::numTypes();
+  for (unsigned int i = 0; i < numGoods; ++i) {
+    double excess = demand.getAmount(i);
+    double currentVolume = max(volume.getAmount(i), 1.0);
     // Want price response of 1% when unfilled orders are 10% of volume,
     // otherwise linear, but never larger than 25%.
-    ratio *= 0.1;
-    if (ratio > 0.25) ratio = 0.25;
-    if (demand.getAmount(*tg) < 0) ratio *= ((*tg)->getStickiness() - 1); // More sellers than buyers, reduce price. Prices are sticky downwards!
-    prices.deliverGoods((*tg), ratio * prices.getAmount(*tg));
-  } 
+    double ratio = min(0.1 * fabs(excess) / currentVolume, 0.25);
+    ratio = (fabs(excess) * 10000 < currentVolume ? 0.0 : ratio);
+    ratio *= (excess < 0 ? downwards.getAmount(i) : 1.0); // More sellers than buyers, reduce price. Prices are sticky downwards!
+    prices.setAmount(i, prices.getAmount(i) * (1 + ratio));
+  }
 }
 
 void Market::unitTests () {
@@ -215,12 +221,12 @@ void Market::unitTests () {
   EconActor buyer;
   EconActor seller;
 
-  vector<MarketBid*> bids;
-  vector<MarketBid*> notMatched;
+  BidSink bids;
+  BidSink notMatched;
 
   // Exact match of buy and sell offers should result in one contract.
-  bids.push_back(new MarketBid(TradeGood::Labor, 100, &buyer, 1));
-  bids.push_back(new MarketBid(TradeGood::Labor, -100, &seller, 1));
+  bids.addBid(TradeGood::Labor, 100, &buyer, 1);
+  bids.addBid(TradeGood::Labor, -100, &seller, 1);
   testMarket.prices.deliverGoods(TradeGood::Labor, 1);
   testMarket.makeContracts(bids, notMatched);
   if (0 != notMatched.size()) throw string("Bids should match");
@@ -241,7 +247,7 @@ void Market::unitTests () {
   if (fabs(seller.getAmount(TradeGood::Money) - contract->delivered * contract->price) > 0.01) throw string("Fix this error string");
 
   // Buy offer only should not give a new contract, but should give a no-match.
-  bids.push_back(new MarketBid(TradeGood::Labor, 100, &buyer, 1));
+  bids.addBid(TradeGood::Labor, 100, &buyer, 1);
   testMarket.makeContracts(bids, notMatched);
   if (0 != testMarket.contracts.size()) throw string("Fix this error string");
   if (1 != notMatched.size()) throw string("Fix this error string");
@@ -256,7 +262,7 @@ void Market::unitTests () {
   // Conversely, sell offer should reduce price.
   oldLabourPrice = newLabourPrice;
   notMatched.clear();
-  notMatched.push_back(new MarketBid(TradeGood::Labor, -100, &seller, 1));
+  notMatched.addBid(TradeGood::Labor, -100, &seller, 1);
   testMarket.adjustPrices(notMatched);
   newLabourPrice = testMarket.prices.getAmount(TradeGood::Labor);
   if (oldLabourPrice <= newLabourPrice) throw string("Fix this error string");
@@ -264,9 +270,9 @@ void Market::unitTests () {
   notMatched.clear();
   oldLabourPrice = newLabourPrice;
   EconActor* secondBuyer = new EconActor();
-  bids.push_back(new MarketBid(TradeGood::Labor, -100, &seller, 1));
-  bids.push_back(new MarketBid(TradeGood::Labor, 90, secondBuyer, 1));
-  bids.push_back(new MarketBid(TradeGood::Labor, 25, &buyer, 1));
+  bids.addBid(TradeGood::Labor, -100, &seller, 1);
+  bids.addBid(TradeGood::Labor, 90, secondBuyer, 1);
+  bids.addBid(TradeGood::Labor, 25, &buyer, 1);
   testMarket.makeContracts(bids, notMatched);
   // Should make two contracts, with some buy left over.
   if (2 != testMarket.contracts.size()) throw string("Fix this error string");
@@ -286,12 +292,12 @@ void Market::unitTests () {
   class Labourer : public EconActor {
   public:
     Labourer (TradeGood const* const tg) : EconActor(), food(tg) {setAmount(TradeGood::Money, 1e7);}
-    virtual void getBids (const GoodsHolder& prices, vector<MarketBid*>& bidlist) {
+    virtual void getBids (const GoodsHolder& prices, BidSink& bidlist) {
       double labourToSell = prices.getAmount(TradeGood::Labor);
-      bidlist.push_back(new MarketBid(TradeGood::Labor, -labourToSell, this, 1));
+      bidlist.addBid(TradeGood::Labor, -labourToSell, this, 1);
       double expectedWages = labourToSell * prices.getAmount(TradeGood::Labor);
       double foodToBuy = expectedWages / prices.getAmount(food);
-      bidlist.push_back(new MarketBid(food, foodToBuy, this, 1));
+      bidlist.addBid(food, foodToBuy, this, 1);
     }
     virtual double produceForContract (TradeGood const* const tg, double amount) {if (tg == TradeGood::Labor) return amount; return 0;}
   private:
@@ -300,11 +306,11 @@ void Market::unitTests () {
   class FoodProducer : public EconActor {
   public:
     FoodProducer (TradeGood const* const tg) : EconActor(), output(tg) {setAmount(TradeGood::Money, 1e7);}
-    virtual void getBids (const GoodsHolder& prices, vector<MarketBid*>& bidlist) {
+    virtual void getBids (const GoodsHolder& prices, BidSink& bidlist) {
       double labourToBuy = 20 - prices.getAmount(TradeGood::Labor);
-      bidlist.push_back(new MarketBid(TradeGood::Labor, labourToBuy, this, 1));
+      bidlist.addBid(TradeGood::Labor, labourToBuy, this, 1);
       double foodToSell = labourToBuy;
-      bidlist.push_back(new MarketBid(output, -foodToSell, this, 1));
+      bidlist.addBid(output, -foodToSell, this, 1);
     }
     virtual double produceForContract (TradeGood const* const tg, double amount) {if (tg == output) return amount; return 0;}
   private:
@@ -373,7 +379,7 @@ void Market::registerParticipant (EconActor* ea) {
 }
 
 void Market::setMirrorState () {
-  mirror->prices.setAmounts(prices);
+  getMirror()->prices.setAmounts(prices);
 }
 
 void Market::unRegisterParticipant (EconActor* ea) {
@@ -8,18 +8,42 @@
 
 struct MarketBid {
   MarketBid(TradeGood const* tg, double atb, EconActor* b, unsigned int d = 1) : tradeGood(tg), amountToBuy(atb), bidder(b), duration(d) {}
-  
+
   TradeGood const* tradeGood;
   double amountToBuy;
   EconActor* bidder;
   unsigned int duration;
 };
 
+// Contiguous, value-typed buffer that EconActor::getBids appends to.
+class BidSink {
+  friend class Market;
+public:
+  typedef vector<MarketBid>::iterator iterator;
+  typedef vector<MarketBid>::const_iterator const_iterator;
+
+  void addBid (TradeGood const* tg, double amount, EconActor* bidder, unsigned int duration = 1) {buffer.push_back(MarketBid(tg, amount, bidder, duration));}
+  void clear () {buffer.clear();}
+  unsigned int size () const {return buffer.size();}
+  const MarketBid& operator[] (unsigned int i) const {return buffer[i];}
+  iterator begin () {return buffer.begin();}
+  iterator end () {return buffer.end();}
+  const_iterator begin () const {return buffer.begin();}
+  const_iterator end () const {return buffer.end();}
+
+private:
+  vector<MarketBid> buffer;
+};
+
 struct MarketContract {
   MarketContract (MarketBid* one, MarketBid* two, double p, unsigned int duration);
   MarketContract (EconActor* s, EconActor* r, double p, unsigned int rmt, const TradeGood* tg, double amt);
   ~MarketContract ();
 
+  // Contracts outlive the market turn, so they recycle through a pool.
+  static void* operator new (size_t size);
+  static void operator delete (void* dat);
+
   void    clear ();
   double  execute ();
   doublet execute (MarketContract* other);
@@ -39,6 +63,8 @@ struct MarketContract {
 private:
   double deliver (double amountWanted);
   double remaining () const {return amount - delivered;}
+
+  static ObjectPool<MarketContract> pool;
 };
 
 class Market : public Mirrorable<Market>, public TBRIDGE(Market) {
@@ -67,9 +93,9 @@ public:
 private:
   Market (Market* other);
 
-  void adjustPrices(vector<MarketBid*>& notMatched);
+  void adjustPrices(const BidSink& notMatched);
   void executeContracts ();
-  void makeContracts(vector<MarketBid*>& bids, vector<MarketBid*>& notMatched);
+  void makeContracts(BidSink& bids, BidSink& notMatched);
   void normalisePrices ();
   
   GoodsHolder prices;
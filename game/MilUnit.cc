@@ -16,6 +16,7 @@ vector<double> MilUnit::priorityLevels;
 double MilUnit::defaultDecayConstant = 1000; 
 vector<double> MilUnitTemplate::drillEffects;
 vector<TransportUnit*> TransportUnit::forDeletion;
+ObjectPool<TransportUnit> TransportUnit::pool;
 
 const double FORAGE_CASUALTY_RATE = 0.01;
 const double FORAGE_LOOT_RATE = 0.1;
@@ -48,6 +49,18 @@ MilUnit::MilUnit (MilUnit* other)
   , graphicsInfo(0)
 {}
 
+MilUnit::MilUnit (Scratch) 
+  : Unit()
+  , Mirrorable<MilUnit>()
+  , Named<MilUnit, false>()
+  , Iterable<MilUnit>(0)
+  , priority(4)
+  , fightFraction(1.0)
+  , graphicsInfo(0)
+  , aggression(0.25)
+  , castle(0)
+{}
+
 MilUnit::~MilUnit () {
   for (std::vector<MilUnitElement*>::iterator f = forces.begin(); f != forces.end(); ++f) {
     (*f)->destroyIfReal();
@@ -77,6 +90,16 @@ void MilUnit::addElement (MilUnitTemplate const* const temp, AgeTracker& str) {
   recalcElementAttributes(); 
 }
 
+MilUnit* MilUnit::createEstimate () {
+  MilUnit* ret = new MilUnit(Scratch());
+  ret->setOwner(getOwner());
+  ret->priority = priority;
+  ret->aggression = aggression;
+  ret->fightFraction = fightFraction;
+  ret->castle = castle;
+  return ret;
+}
+
 void MilUnit::demobilise (AgeTracker& target) {
   for (ElmIter i = forces.begin(); i != forces.end(); ++i) {
     for (int j = 0; j < AgeTracker::maxAge; ++j) {
@@ -84,6 +107,7 @@ void MilUnit::demobilise (AgeTracker& target) {
     }
     (*i)->soldiers->clear(); 
   }
+  invalidateStrength();
 }
 
 /*
@@ -139,17 +163,17 @@ MilUnitElement::MilUnitElement (MilUnitTemplate const* const mut)
   , unitType(mut)
 {
   soldiers = new AgeTracker();
-  mirror->soldiers = soldiers->getMirror();
   supply = mut->supplyLevels.begin();
 }
 
 MilUnitElement::MilUnitElement (MilUnitElement* other)
   : Mirrorable<MilUnitElement>(other)
   , unitType(other->unitType)
+  , soldiers(0)
 {}
 
 MilUnitElement::~MilUnitElement () {
-  soldiers->destroyIfReal(); 
+  if (soldiers) soldiers->destroyIfReal(); 
 }
 
 void MilUnitElement::reCalculate () {
@@ -160,14 +184,14 @@ void MilUnitElement::reCalculate () {
 }
 
 void MilUnitElement::setMirrorState () {
-  mirror->shock      = shock;
-  mirror->range      = range;
-  mirror->defense    = defense;
-  mirror->tacmob     = tacmob;
-  mirror->unitType   = unitType;
+  getMirror()->shock      = shock;
+  getMirror()->range      = range;
+  getMirror()->defense    = defense;
+  getMirror()->tacmob     = tacmob;
+  getMirror()->unitType   = unitType;
   soldiers->setMirrorState();
-  mirror->soldiers   = soldiers->getMirror();
-  mirror->supply     = supply;
+  getMirror()->soldiers   = soldiers->getMirror();
+  getMirror()->supply     = supply;
 }
 
 void MilUnit::receiveTransportUnit (TransportUnit* transport) {
@@ -197,20 +221,21 @@ void MilUnit::setLocation (Vertex* dat) {
 }
 
 void MilUnit::setMirrorState () {
-  mirror->setOwner(getOwner());
-  mirror->setRear(getRear());
-  mirror->priority = priority;
-  mirror->modStack = modStack;
-  mirror->aggression = aggression;
-  mirror->fightFraction = fightFraction;
-  mirror->castle = castle ? castle->getMirror() : 0;
-
-  mirror->forces.clear();
+  getMirror()->setOwner(getOwner());
+  getMirror()->setRear(getRear());
+  getMirror()->priority = priority;
+  getMirror()->modStack = modStack;
+  getMirror()->aggression = aggression;
+  getMirror()->fightFraction = fightFraction;
+  getMirror()->castle = castle ? castle->getMirror() : 0;
+
+  getMirror()->forces.clear();
   for (ElmIter i = forces.begin(); i != forces.end(); ++i) {
     (*i)->setMirrorState();
-    mirror->forces.push_back((*i)->getMirror());     
+    getMirror()->forces.push_back((*i)->getMirror());     
   }
-  setEconMirrorState(mirror);
+  getMirror()->invalidateStrength();
+  setEconMirrorState(getMirror());
 }
 
 int MilUnit::totalSoldiers () const {
@@ -234,15 +259,25 @@ double MilUnit::effectiveMobility (MilUnit* const versus) {
 
   int enemyNumber = versus->totalSoldiers();
   enemyNumber /= 2;
-  sort(forces.begin(), forces.end(), deref<MilUnitElement>(member_descending(&MilUnitElement::tacmob)));
+  const vector<MilUnitElement*>& fastestLast = sortedBy(&MilUnitElement::tacmob);
 
   int count = 0;
-  for (CElmIter i = forces.begin(); i != forces.end(); ++i) {
+  for (vector<MilUnitElement*>::const_reverse_iterator i = fastestLast.rbegin(); i != fastestLast.rend(); ++i) {
     count += (*i)->strength();
     if (count > enemyNumber) return (*i)->tacmob;
   }
 
-  return forces.back()->tacmob;
+  return fastestLast.front()->tacmob;
+}
+
+const vector<MilUnitElement*>& MilUnit::sortedBy (double MilUnitElement::*field) {
+  for (unsigned int i = 0; i < sortedForces.size(); ++i) {
+    if (sortedForces[i].first == field) return sortedForces[i].second;
+  }
+  sortedForces.push_back(pair<double MilUnitElement::*, vector<MilUnitElement*> >(field, forces));
+  vector<MilUnitElement*>& ret = sortedForces.back().second;
+  sort(ret.begin(), ret.end(), deref<MilUnitElement>(member_lt(field)));
+  return ret;
 }
 
 double MilUnit::calcStrength (double lifetime, double MilUnitElement::*field) {
@@ -251,21 +286,33 @@ double MilUnit::calcStrength (double lifetime, double MilUnitElement::*field) {
   // Higher lifetime is better.
 
   if (0 == forces.size()) return 0;
-  if (0 == totalSoldiers()) return 0;
+  BOOST_FOREACH(const CachedStrength& cs, strengthCache) {
+    if ((cs.field == field) && (cs.lifetime == lifetime) && (cs.fraction == fightFraction)) return cs.strength;
+  }
+
+  CachedStrength computed = {field, lifetime, fightFraction, 0};
+  if (0 == totalSoldiers()) {
+    strengthCache.push_back(computed);
+    return 0;
+  }
   double gamma = 1.0 / lifetime;
 
-  sort(forces.begin(), forces.end(), deref<MilUnitElement>(member_lt(field)));
   double totalStrength = 0;
+  double remaining = 1; // exp(-gamma*totalStrength), carried over to save an exp per element.
   double ret = 0;
-  for (CElmIter i = forces.begin(); i != forces.end(); ++i) {
-    double curr = (*i)->*field;
-    double nums = (*i)->strength() * fightFraction;
+  BOOST_FOREACH(MilUnitElement* mue, sortedBy(field)) {
+    double curr = mue->*field;
+    double nums = mue->strength() * fightFraction;
     if (1 > nums) continue;
-    ret += curr * (exp(-gamma*totalStrength) - exp(-gamma*(totalStrength + nums)));
     totalStrength += nums;
+    double next = exp(-gamma*totalStrength);
+    ret += curr * (remaining - next);
+    remaining = next;
   }
   ret *= lifetime;
-  return 1 + ret;
+  computed.strength = 1 + ret;
+  strengthCache.push_back(computed);
+  return computed.strength;
 }
 
 void MilUnit::endOfTurn () {
@@ -276,6 +323,7 @@ void MilUnit::endOfTurn () {
     for (ElmIter i = forces.begin(); i != forces.end(); ++i) {
       (*i)->soldiers->age();
     }
+    invalidateStrength();
     return;
   }
 
@@ -365,6 +413,7 @@ void MilUnit::lootHex (Hex* hex) {
     double rate = theirCasualties / mu->totalSoldiers();
     totalKilled += mu->takeCasualties(rate);
   }
+  if (hex->getVillage()) hex->getVillage()->getMilitiaTradition()->invalidateEstimate();
   if (isReal()) graphicsInfo->addEvent(DisplayEvent(createString("Skirmish against %s militia", hex->getName().c_str()),
 						    createString("Killed %i, lost %i\nLoot:%s",
 								 totalKilled,
@@ -383,6 +432,7 @@ int MilUnit::takeCasualties (double rate) {
       delete (*i);
     }
     forces.clear(); 
+    invalidateStrength();
   }
   else {
     for (ElmIter i = forces.begin(); i != forces.end(); ++i) {
@@ -467,6 +517,72 @@ double MilUnit::calcBattleCasualties (MilUnit* const adversary, BattleResult* ou
   return myTotCasRate;   
 }
 
+void CombatBatch::add (MilUnit* defender, MilUnit* attacker, double w) {
+  if (0 == attacker->forces.size()) return; // calcBattleCasualties would return zero.
+  myMob.push_back(defender->effectiveMobility(attacker));
+  myShk.push_back(defender->calcStrength(defender->getDecayConstant(), &MilUnitElement::shock));
+  myFir.push_back(defender->calcStrength(defender->getDecayConstant(), &MilUnitElement::range));
+  myAgg.push_back(defender->aggression);
+  mySoldiers.push_back(defender->totalSoldiers());
+  thMob.push_back(attacker->effectiveMobility(defender));
+  thShk.push_back(attacker->calcStrength(attacker->getDecayConstant(), &MilUnitElement::shock));
+  thFir.push_back(attacker->calcStrength(attacker->getDecayConstant(), &MilUnitElement::range));
+  thAgg.push_back(attacker->aggression);
+  weight.push_back(w);
+}
+
+void CombatBatch::clear () {
+  myMob.clear();
+  myShk.clear();
+  myFir.clear();
+  myAgg.clear();
+  mySoldiers.clear();
+  thMob.clear();
+  thShk.clear();
+  thFir.clear();
+  thAgg.clear();
+  weight.clear();
+}
+
+void CombatBatch::lossRates (vector<double>& rates) const {
+  // Same arithmetic as calcBattleCasualties and getShockRange, with the
+  // branches written as selects so the loop can be vectorised.
+  unsigned int numPairs = size();
+  rates.resize(numPairs);
+  for (unsigned int i = 0; i < numPairs; ++i) {
+    double total = thMob[i] + myMob[i];
+    double mobRatio = (myMob[i] < thMob[i] ? (myMob[i] / total) * (myMob[i] / total) : 1.0 - (thMob[i] / total) * (thMob[i] / total));
+    double shkRatio = thShk[i] / myShk[i];
+    double firRatio = thFir[i] / myFir[i];
+
+    double myShkPref = 1.0 / shkRatio;
+    double myFirPref = (myShk[i] > 10*myFir[i] ? 0 : 1.0 / firRatio);
+    bool myShock = (myShkPref > 0.8*myFirPref);
+    double myWilling = (myShock ? myShkPref : myFirPref) > (1 - myAgg[i]) ? mobRatio : 0;
+
+    double thShkPref = shkRatio;
+    double thFirPref = (thShk[i] > 10*thFir[i] ? 0 : firRatio);
+    bool thShock = (thShkPref > 0.8*thFirPref);
+    double thWilling = (thShock ? thShkPref : thFirPref) > (1 - thAgg[i]) ? (1.0 - mobRatio) : 0;
+
+    double shkPercentage = (myShock ? myWilling : 0) + (thShock ? thWilling : 0);
+    double firPercentage = (myShock ? 0 : myWilling) + (thShock ? 0 : thWilling);
+
+    double myShkCasRate = 0.03 * thShk[i] * min(1.0, shkRatio);
+    double myFirCasRate = 0.01 * thFir[i] * min(1.0, firRatio);
+    double myTotCasRate = myShkCasRate * shkPercentage + myFirCasRate * firPercentage;
+    rates[i] = min(myTotCasRate / mySoldiers[i], 0.15);
+  }
+}
+
+double CombatBatch::weightedLosses () const {
+  vector<double> rates;
+  lossRates(rates);
+  double ret = 0;
+  for (unsigned int i = 0; i < rates.size(); ++i) ret += rates[i] * weight[i];
+  return ret;
+}
+
 double MilUnit::calcRoutCasualties (MilUnit* const adversary) {
   double ratio = std::max(1.0, calcStrength(getDecayConstant(), &MilUnitElement::tacmob) - adversary->calcStrength(adversary->getDecayConstant(), &MilUnitElement::range));
   ratio /= std::max(1.0, adversary->calcStrength(getDecayConstant(), &MilUnitElement::tacmob) - calcStrength(adversary->getDecayConstant(), &MilUnitElement::range));
@@ -546,7 +662,7 @@ int MilUnit::getScoutingModifier (MilUnit* const adversary) {
   return 0;
 }
 
-void MilUnit::getBids (const GoodsHolder& prices, vector<MarketBid*>& bidlist) {
+void MilUnit::getBids (const GoodsHolder& prices, BidSink& bidlist) {
   list<pair<MilUnitElement const*, supIter> > levels;
   GoodsHolder availableResources(*this);
   GoodsHolder wanted;
@@ -590,7 +706,7 @@ void MilUnit::getBids (const GoodsHolder& prices, vector<MarketBid*>& bidlist) {
   }
   for (TradeGood::Iter tg = TradeGood::exLaborStart(); tg != TradeGood::final(); ++tg) {
     if (0.01 > wanted.getAmount(*tg)) continue;
-    bidlist.push_back(new MarketBid((*tg), wanted.getAmount(*tg), this));
+    bidlist.addBid((*tg), wanted.getAmount(*tg), this);
   }
 }
 
@@ -600,6 +716,7 @@ double MilUnit::getForageStrength () {
 
 void MilUnit::recalcElementAttributes () {
   BOOST_FOREACH(MilUnitElement* mue, forces) mue->reCalculate();
+  invalidateStrength();
   // TODO: Deal with synergies, whatnot.
 }
 
@@ -648,14 +765,35 @@ void MilUnit::unitTests () {
 						     casualtiesOne,
 						     casualtiesTwo);
 
+  // Entity ids stay fixed while iteration slots are compacted, and a
+  // destroyed unit's id is handed out again before any new one.
+  MilUnit* testThree = getTestUnit();
+  MilUnit* testFour = getTestUnit();
+  unsigned int capacity = idCapacity();
+  if ((testThree->getEntityId() >= capacity) || (testFour->getEntityId() >= capacity)) {
+    throwFormatted("Expected entity ids %i and %i to be below capacity %i", testThree->getEntityId(), testFour->getEntityId(), capacity);
+  }
+  if ((testThree->getEntityId() == testFour->getEntityId()) || (testOne->getEntityId() == testThree->getEntityId()) || (testTwo->getEntityId() == testFour->getEntityId())) throwFormatted("Expected distinct entity ids");
+  if (capacity < totalAmount()) throwFormatted("Expected id capacity %i to cover all %i units", capacity, totalAmount());
+  unsigned int freedId = testThree->getEntityId();
+  unsigned int fourId = testFour->getEntityId();
+  delete testThree;
+  if (testFour->getEntityId() != fourId) throwFormatted("Expected entity id %i to survive destruction of another unit, got %i", fourId, testFour->getEntityId());
+  if (*(Iterable<MilUnit>::start() + testFour->getSlot()) != testFour) throwFormatted("Expected unit to be found at its iteration slot %i", testFour->getSlot());
+  MilUnit* testFive = getTestUnit();
+  if (testFive->getEntityId() != freedId) throwFormatted("Expected freed entity id %i to be reused, got %i", freedId, testFive->getEntityId());
+  if (idCapacity() != capacity) throwFormatted("Expected id capacity to stay at %i when reusing ids, got %i", capacity, idCapacity());
+  delete testFour;
+  delete testFive;
+
   testOne->setAmount(TradeGood::Money, 1000000);
   GoodsHolder prices;
-  vector<MarketBid*> bidlist;
+  BidSink bidlist;
   for (TradeGood::Iter tg = TradeGood::exLaborStart(); tg != TradeGood::final(); ++tg) prices.setAmount((*tg), 1);
   testOne->getBids(prices, bidlist);
   if (0 == bidlist.size()) throwFormatted("Expected unit to bid on goods");
   GoodsHolder actualBids;
-  BOOST_FOREACH(MarketBid* mb, bidlist) actualBids.deliverGoods(mb->tradeGood, mb->amountToBuy);
+  BOOST_FOREACH(const MarketBid& mb, bidlist) actualBids.deliverGoods(mb.tradeGood, mb.amountToBuy);
   GoodsHolder expectedBids;
   for (supIter level = unitType->supplyLevels.begin(); level != unitType->supplyLevels.end(); ++level) expectedBids += (*level);
   expectedBids *= 1000;
@@ -675,6 +813,50 @@ void MilUnit::unitTests () {
   if (0.01 > totalExpected) throwFormatted("Expected total bid should not be zero!");
   if (0.01 > totalActual) throwFormatted("Actual total bid should not be zero!");
 
+  // A convoy next to its unit arrives in one turn, hands over its goods,
+  // and is gone from iteration once cleaned up.
+  Hex* convoyHex = Hex::getTestHex(false, false, false, false);
+  Vertex* home = convoyHex->getVertex(0);
+  Vertex* front = 0;
+  for (Vertex::NeighbourIterator n = home->beginNeighbours(); (!front) && (n != home->endNeighbours()); ++n) front = (*n);
+  if (!front) throwFormatted("Expected test vertex to have a neighbour");
+  MilUnit* supplied = getTestUnit();
+  front->addUnit(supplied);
+  TradeGood const* convoyGood = *(TradeGood::exLaborStart());
+  double suppliesBefore = supplied->getAmount(convoyGood);
+  unsigned int convoysBefore = TransportUnit::totalAmount();
+  TransportUnit* convoy = new TransportUnit(supplied);
+  convoy->setLocation(home);
+  convoy->setAmount(convoyGood, 10);
+  convoy->endOfTurn();
+  if (fabs(supplied->getAmount(convoyGood) - suppliesBefore - 10) > 0.001) throwFormatted("Expected convoy to deliver 10 %s, unit went from %.2f to %.2f",
+											  convoyGood->getName().c_str(),
+											  suppliesBefore,
+											  supplied->getAmount(convoyGood));
+  TransportUnit::cleanUp();
+  if (convoysBefore != TransportUnit::totalAmount()) throwFormatted("Expected %i convoys after delivery, found %i", convoysBefore, TransportUnit::totalAmount());
+  for (TransportUnit::Iterator tu = TransportUnit::start(); tu != TransportUnit::final(); ++tu) {
+    if ((*tu) == convoy) throwFormatted("Delivered convoy should no longer be iterated over");
+  }
+  front->removeUnit();
+  delete supplied;
+  delete convoyHex;
+
+  CombatBatch batch;
+  batch.add(testOne, testTwo, 2);
+  batch.add(testTwo, testOne, 3);
+  double batchLosses = batch.weightedLosses();
+  double pairLosses = 2*testOne->calcBattleCasualties(testTwo) + 3*testTwo->calcBattleCasualties(testOne);
+  if (fabs(batchLosses - pairLosses) > 0.0001) throwFormatted("Expected batched casualties %.4f to match pairwise %.4f", batchLosses, pairLosses);
+
+  MilUnit* casualtyTest = getTestUnit();
+  double shockBefore = casualtyTest->calcStrength(casualtyTest->getDecayConstant(), &MilUnitElement::shock);
+  if (fabs(shockBefore - casualtyTest->calcStrength(casualtyTest->getDecayConstant(), &MilUnitElement::shock)) > 0.0001) throwFormatted("Cached strength should equal calculated strength");
+  casualtyTest->takeCasualties(0.5);
+  double shockAfter = casualtyTest->calcStrength(casualtyTest->getDecayConstant(), &MilUnitElement::shock);
+  if (shockAfter >= shockBefore) throwFormatted("Expected shock strength to drop after casualties, but went from %.2f to %.2f", shockBefore, shockAfter);
+  delete casualtyTest;
+
   Hex* testHex = Hex::getTestHex();
   Village* testVillage = testHex->getVillage();
   testHex->setOwner(playerTwo);
@@ -777,9 +959,12 @@ TransportUnit::TransportUnit (MilUnit* t)
   , target(t)
 {
   setOwner(t->getOwner());
+  GraphicsInfo::sceneChanged();
 }
 
-TransportUnit::~TransportUnit () {}
+TransportUnit::~TransportUnit () {
+  if (isReal()) GraphicsInfo::sceneChanged();
+}
 
 TransportUnit::TransportUnit (TransportUnit* other)
   : Unit()
@@ -788,10 +973,19 @@ TransportUnit::TransportUnit (TransportUnit* other)
   , GBRIDGE(TransportUnit)()
 {}
 
+void* TransportUnit::operator new (size_t size) {
+  assert(sizeof(TransportUnit) == size);
+  return pool.allocate();
+}
+
+void TransportUnit::operator delete (void* dat) {
+  pool.release(dat);
+}
+
 void TransportUnit::setMirrorState () {
-  mirror->target = target->getMirror();
-  mirror->setLocation(getLocation()->getMirror());
-  setEconMirrorState(mirror);
+  getMirror()->target = target->getMirror();
+  getMirror()->setLocation(getLocation()->getMirror());
+  setEconMirrorState(getMirror());
 }
 
 void TransportUnit::endOfTurn () {
@@ -813,6 +1007,7 @@ void TransportUnit::endOfTurn () {
   }
 
   destination = route[0];
+  if (isReal()) GraphicsInfo::sceneChanged();
   for (int i = 0; i < 3; ++i) {
     route.pop_back(); // Route begins with current vertex, so strip that off.
     if (0 == route.size()) break; // This should never happen.
@@ -848,10 +1043,10 @@ TradeUnit::TradeUnit (TradeUnit* other)
 {}
 
 void TradeUnit::setMirrorState () {
-  mirror->setLocation(getLocation()->getMirror());
-  setEconMirrorState(mirror);
-  mirror->mostRecentMarket = mostRecentMarket ? mostRecentMarket->getMirror() : 0;
-  mirror->tradingTarget = tradingTarget ? tradingTarget->getMirror() : 0;
+  getMirror()->setLocation(getLocation()->getMirror());
+  setEconMirrorState(getMirror());
+  getMirror()->mostRecentMarket = mostRecentMarket ? mostRecentMarket->getMirror() : 0;
+  getMirror()->tradingTarget = tradingTarget ? tradingTarget->getMirror() : 0;
 }
 
 bool TradeUnit::MarketFinder::operator ()(Vertex* dat) const {
@@ -955,20 +1150,20 @@ void TradeUnit::endOfTurn () {
   }
 }
 
-void TradeUnit::getBids (const GoodsHolder& prices, vector<MarketBid*>& bidlist) {
+void TradeUnit::getBids (const GoodsHolder& prices, BidSink& bidlist) {
   // Buy one good that we can sell dearer. Sell anything that's more expensive
   // here than where we picked it up.
 
   findTradeTarget();
   for (TradeGood::Iter tg = TradeGood::exLaborStart(); tg != TradeGood::final(); ++tg) {
     if (tg == goodToBuy) {
-      bidlist.push_back(new MarketBid((*tg), getAmount(TradeGood::Money) / prices.getAmount(*tg), this));
+      bidlist.addBid((*tg), getAmount(TradeGood::Money) / prices.getAmount(*tg), this);
       lastPricesPaid.setAmount((*tg), prices.getAmount(*tg));
       continue;
     }
     if (prices.getAmount(*tg) <= lastPricesPaid.getAmount(*tg)) continue;
     if (getAmount(*tg) < 1) continue;
-    bidlist.push_back(new MarketBid((*tg), -getAmount(*tg), this));
+    bidlist.addBid((*tg), -getAmount(*tg), this);
   }
 }
 
@@ -1027,11 +1222,11 @@ void TradeUnit::unitTests () {
 
   GoodsHolder prices;
   market1->getPrices(prices);
-  vector<MarketBid*> bidlist;
+  BidSink bidlist;
   testUnit->getBids(prices, bidlist);
   if (1 != bidlist.size()) throwFormatted("Expected 1 bid, got %i", bidlist.size());
-  MarketBid* testBid = bidlist[0];
-  if (testBid->tradeGood != testGood) throwFormatted("Expected bid for %s, got %s", testGood->getName().c_str(), testBid->tradeGood->getName().c_str());
+  const MarketBid& testBid = bidlist[0];
+  if (testBid.tradeGood != testGood) throwFormatted("Expected bid for %s, got %s", testGood->getName().c_str(), testBid.tradeGood->getName().c_str());
 
   testUnit->endOfTurn();
   if (testUnit->getLocation() != testVertex2) throwFormatted("Expected trade unit to reach target");
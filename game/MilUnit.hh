@@ -94,12 +94,15 @@ class MilUnit : public Unit, public Mirrorable<MilUnit>, public Named<MilUnit, f
   friend class Mirrorable<MilUnit>;
   friend class StaticInitialiser;
   friend class MilUnitGraphicsInfo; 
+  friend class CombatBatch;
 public:
   MilUnit ();
   ~MilUnit ();
 
   // Strength manipulations
   void addElement (MilUnitTemplate const* const temp, AgeTracker& str);
+  // Soldierless hypothetical copy, not iterable, owned by the caller.
+  MilUnit* createEstimate ();
   //void clear ();
   //MilUnit* detach (double fraction);
   void demobilise (AgeTracker& target); 
@@ -111,7 +114,8 @@ public:
   double calcRoutCasualties (MilUnit* const adversary);
   string displayString (int indent) const;
   double effectiveMobility (MilUnit* const versus);
-  virtual void getBids (const GoodsHolder& prices, vector<MarketBid*>& bidlist);
+  using EconActor::getBids;
+  virtual void getBids (const GoodsHolder& prices, BidSink& bidlist);
   Castle const* getCastle () const {return castle;}
   double getDecayConstant () const {return defaultDecayConstant * (modStack.size() > 0 ? modStack.top() : 1);}
   double getForageStrength ();
@@ -142,6 +146,8 @@ public:
 
 private:
   MilUnit (MilUnit* other); 
+  struct Scratch {};
+  MilUnit (Scratch); // Real but not iterable and without graphics; see createEstimate.
 
   void consumeSupplies ();
   void forage ();
@@ -149,8 +155,21 @@ private:
   void recalcElementAttributes (); 
   int takeCasualties (double rate);
   void getShockRange (double shkRatio, double firRatio, double mobRatio, double& shkPercent, double& firPercent) const;
+  void invalidateStrength () {strengthCache.clear(); sortedForces.clear();}
+  const vector<MilUnitElement*>& sortedBy (double MilUnitElement::*field);
+
+  struct CachedStrength {
+    double MilUnitElement::*field;
+    double lifetime;
+    double fraction;
+    double strength;
+  };
 
   vector<MilUnitElement*> forces;
+  // calcStrength results and per-field ascending element orders; cleared
+  // whenever the elements' numbers or attributes change.
+  vector<CachedStrength> strengthCache;
+  vector<pair<double MilUnitElement::*, vector<MilUnitElement*> > > sortedForces;
   int priority;
   std::stack<double> modStack;
   double fightFraction;  // For use in hypotheticals: If this unit were at X% strength. 
@@ -181,6 +200,33 @@ struct BattleResult {
   Outcome dieRoll;
 };
 
+// Estimates calcBattleCasualties for many defender/attacker pairs at
+// once. add() reads each pair's strengths straight away, so units may be
+// changed afterwards; the casualty arithmetic then runs over all pairs
+// in a single branch-free pass.
+class CombatBatch {
+public:
+  void add (MilUnit* defender, MilUnit* attacker, double weight = 1);
+  void clear ();
+  unsigned int size () const {return weight.size();}
+  // Defender loss rate for each pair, as calcBattleCasualties would return.
+  void lossRates (vector<double>& rates) const;
+  // Sum of each pair's loss rate times its weight.
+  double weightedLosses () const;
+
+private:
+  vector<double> myMob;
+  vector<double> myShk;
+  vector<double> myFir;
+  vector<double> myAgg;
+  vector<double> mySoldiers;
+  vector<double> thMob;
+  vector<double> thShk;
+  vector<double> thFir;
+  vector<double> thAgg;
+  vector<double> weight;
+};
+
 class TransportUnit : public Unit, public Iterable<TransportUnit>, public Mirrorable<TransportUnit>, public GBRIDGE(TransportUnit) {
   friend class StaticInitialiser;
   friend class Mirrorable<TransportUnit>;
@@ -191,6 +237,11 @@ public:
   void endOfTurn ();
   virtual void setMirrorState ();
 
+  // Convoys, and their mirrors, are made and destroyed every turn for
+  // every field unit; arrived ones hand their memory back to a pool.
+  static void* operator new (size_t size);
+  static void operator delete (void* dat);
+
   static void cleanUp ();
 
 private:
@@ -199,6 +250,7 @@ private:
   MilUnit* target;
 
   static vector<TransportUnit*> forDeletion;
+  static ObjectPool<TransportUnit> pool;
 };
 
 class TradeUnit : public Unit, public Iterable<TradeUnit>, public Mirrorable<TradeUnit> {
@@ -209,7 +261,8 @@ public:
   virtual ~TradeUnit ();
 
   void endOfTurn ();
-  virtual void getBids (const GoodsHolder& prices, vector<MarketBid*>& bidlist);
+  using EconActor::getBids;
+  virtual void getBids (const GoodsHolder& prices, BidSink& bidlist);
   virtual void setLocation (Vertex* dat);
   virtual void setMirrorState ();
 
@@ -147,7 +147,7 @@ double Player::evaluateGlobalStrength () {
 
 double Player::evaluateAttackStrength (Player* att, Player* def) {
   double ret = 0;
-  double casualties = 0; 
+  CombatBatch battles;
   att->calculateInfluence();
 
   // Returns casualties that would be inflicted by att on def
@@ -170,7 +170,7 @@ double Player::evaluateAttackStrength (Player* att, Player* def) {
 	
 	MilUnit* defender = curr->getGarrison(0);
 	if (!defender) continue;
-	casualties += unit->totalSoldiers() * defender->calcBattleCasualties(unit);
+	battles.add(defender, unit, unit->totalSoldiers());
       }
     }
     else if ((att == curr->getOwner()) && (0 < curr->numGarrison())) {
@@ -182,7 +182,7 @@ double Player::evaluateAttackStrength (Player* att, Player* def) {
 	MilUnit* unit = vtx->getUnit(0);
 	if (!unit) continue;
 	if (unit->getOwner() != def) continue; 
-	casualties += attacker->totalSoldiers() * unit->calcBattleCasualties(attacker); 
+	battles.add(unit, attacker, attacker->totalSoldiers());
       }
       curr->addGarrison(attacker); 
     }
@@ -201,7 +201,7 @@ double Player::evaluateAttackStrength (Player* att, Player* def) {
       MilUnit* defender = (*n)->getUnit(0);
       if (!defender) continue;
       if (def != defender->getOwner()) continue;
-      casualties += mil->totalSoldiers() * defender->calcBattleCasualties(mil);
+      battles.add(defender, mil, mil->totalSoldiers());
     }
 
     for (Vertex::HexIterator h = vtx->beginHexes(); h != vtx->endHexes(); ++h) {
@@ -209,12 +209,12 @@ double Player::evaluateAttackStrength (Player* att, Player* def) {
       if (def != (*h)->getOwner()) continue;
       Village* village = (*h)->getVillage();
       if (!village) continue;
-      MilUnit* defenders = village->raiseMilitia(); 
-      casualties += mil->totalSoldiers() * defenders->calcBattleCasualties(mil);
+      MilUnit* defenders = village->estimateMilitia(); 
+      battles.add(defenders, mil, mil->totalSoldiers());
     }
   } 
 
-  ret += casualtyValue * casualties; 
+  ret += casualtyValue * battles.weightedLosses();
   return ret;
 }
 
@@ -269,7 +269,7 @@ double Player::evaluate (Action act) {
 
   //Logger::logStream(DebugAI) << "\n";
 
-  Logger::logStream(DebugAI) << "Points from " << act.describe() << " : " << ret << "\n"; 
+  LOGSTREAM(DebugAI) << "Points from " << act.describe() << " : " << ret << "\n"; 
   return ret; 
 }
 
@@ -289,6 +289,9 @@ void recursiveStrategicValue (Vertex* vex, Line* source, double mult, double dec
 }
 
 void Player::getAction () { 
+  // Reals don't change until best is executed, so mirrors that are in
+  // sync and untouched by hypothetical actions need not be copied again.
+  MirrorTracking::Scope mirrorTracking;
   std::vector<Action> candidates;
   Action best;
   best.todo = Action::Nothing;
@@ -472,7 +475,7 @@ void Player::getAction () {
 
   best.print = true;
   best.player = this; 
-  Logger::logStream(DebugAI) << "Executing " << best.describe() << " " << bestScore << "\n";
+  LOGSTREAM(DebugAI) << "Executing " << best.describe() << " " << bestScore << "\n";
 
   //if (!(best.todo == Action::Devastate)) best.execute();
   best.execute(); 
@@ -88,6 +88,7 @@ int VillageGraphicsInfo::getHouses () const {
 }
 
 void FarmGraphicsInfo::updateFieldStatus () {
+  sceneChanged();
   for (Iterator info = Iterable<FarmGraphicsInfo>::start(); info != Iterable<FarmGraphicsInfo>::final(); ++info) {
     Farmland* currFarm = (*info)->getGameObject();
     // Status of fields.
@@ -120,6 +121,7 @@ VillageGraphicsInfo::VillageGraphicsInfo (Village* f)
 VillageGraphicsInfo::~VillageGraphicsInfo () {}
 
 void VillageGraphicsInfo::updateVillageStatus () {
+  sceneChanged();
   for (Iterator info = Iterable<VillageGraphicsInfo>::start(); info != Iterable<VillageGraphicsInfo>::final(); ++info) {
     (*info)->spriteIndices.clear();
     (*info)->formation.clear();
@@ -0,0 +1,50 @@
+#include "Frustum.hh"
+
+Frustum::Frustum () {
+  // Until told otherwise, everything is visible.
+  for (int i = 0; i < 6; ++i) {
+    planes[i][0] = planes[i][1] = planes[i][2] = 0;
+    planes[i][3] = 1;
+  }
+}
+
+void Frustum::setMatrices (const double* projection, const double* modelview) {
+  // Combined clip matrix, element (row, col) at [col*4 + row].
+  double clip[16];
+  for (int col = 0; col < 4; ++col) {
+    for (int row = 0; row < 4; ++row) {
+      clip[col*4 + row] = 0;
+      for (int k = 0; k < 4; ++k) clip[col*4 + row] += projection[k*4 + row] * modelview[col*4 + k];
+    }
+  }
+
+  // Each plane is the fourth row plus or minus one of the others:
+  // left, right, bottom, top, near, far.
+  for (int i = 0; i < 6; ++i) {
+    int row = i / 2;
+    double sign = (0 == i % 2) ? 1 : -1;
+    for (int col = 0; col < 4; ++col) planes[i][col] = clip[col*4 + 3] + sign * clip[col*4 + row];
+    double length = sqrt(planes[i][0]*planes[i][0] + planes[i][1]*planes[i][1] + planes[i][2]*planes[i][2]);
+    if (0 < length) for (int col = 0; col < 4; ++col) planes[i][col] /= length;
+  }
+}
+
+bool Frustum::boxVisible (const triplet& low, const triplet& high) const {
+  for (int i = 0; i < 6; ++i) {
+    // The corner furthest along the plane normal.
+    double dist = planes[i][3];
+    dist += planes[i][0] * (0 < planes[i][0] ? high.x() : low.x());
+    dist += planes[i][1] * (0 < planes[i][1] ? high.y() : low.y());
+    dist += planes[i][2] * (0 < planes[i][2] ? high.z() : low.z());
+    if (0 > dist) return false;
+  }
+  return true;
+}
+
+bool Frustum::sphereVisible (const triplet& center, double radius) const {
+  for (int i = 0; i < 6; ++i) {
+    double dist = planes[i][0] * center.x() + planes[i][1] * center.y() + planes[i][2] * center.z() + planes[i][3];
+    if (-radius > dist) return false;
+  }
+  return true;
+}
@@ -0,0 +1,22 @@
+#ifndef FRUSTUM_HH
+#define FRUSTUM_HH
+
+#include "UtilityFunctions.hh"
+
+// The six clip planes of the current camera, for skipping objects that
+// cannot appear on screen. Planes point inwards; a point is inside when
+// it is on the positive side of all six.
+class Frustum {
+public:
+  Frustum ();
+
+  // Column-major matrices, as returned by glGetDoublev.
+  void setMatrices (const double* projection, const double* modelview);
+  bool boxVisible (const triplet& low, const triplet& high) const;
+  bool sphereVisible (const triplet& center, double radius) const;
+
+private:
+  double planes[6][4];
+};
+
+#endif
@@ -8,6 +8,7 @@
 
 double LineGraphicsInfo::maxFlow = 1;
 double LineGraphicsInfo::maxLoss = 1;
+unsigned int ZoneGraphicsInfo::meshVersions = 0;
 
 HexGraphicsInfo::~HexGraphicsInfo () {}
 LineGraphicsInfo::~LineGraphicsInfo () {}
@@ -66,6 +67,7 @@ HexGraphicsInfo::HexGraphicsInfo  (Hex* h)
   cornerLeftDown.y() += yIncrement;
   hexX = hpos.first; hexY = hpos.second; getHeightMapCoords(hexX, hexY, LeftDown);
   cornerLeftDown.z() = zOffset + zSeparation * getHeight(hexX, hexY);
+  for (int i = 0; i < NoVertex; ++i) includeInBounds(getCoords((Vertices) i));
 
   ZoneGraphicsInfo* zoneInfo = ZoneGraphicsInfo::getByIndex(0);
   zoneInfo->addHex(this);
@@ -383,6 +385,7 @@ LineGraphicsInfo::LineGraphicsInfo (Line* l, Vertices dir)
   vec2 -= corner1;
   normal = vec1.cross(vec2);
   normal.normalise();
+  for (int i = 0; i < 4; ++i) includeInBounds(getCorner(i));
 
   ZoneGraphicsInfo::getByIndex(0)->addLine(this);
 }
@@ -498,6 +501,7 @@ VertexGraphicsInfo::VertexGraphicsInfo (Vertex* v, HexGraphicsInfo const* hex, V
   position.x() *= 0.333;
   position.y() *= 0.333;
   position.z() *= 0.333;
+  for (int i = 0; i < 3; ++i) includeInBounds(getCorner(i));
 
   ZoneGraphicsInfo::getByIndex(0)->addVertex(this);
 }
@@ -534,9 +538,9 @@ ZoneGraphicsInfo::ZoneGraphicsInfo ()
   , maxY(0)
   , width(0)
   , height(0)
+  , meshVersion(0)
 {
-  heightMap = new double*[zoneSize];
-  for (int i = 0; i < zoneSize; ++i) heightMap[i] = new double[zoneSize];
+  heightMap.resize(zoneSize, zoneSize);
   recalc();
 }
 
@@ -544,6 +548,7 @@ void ZoneGraphicsInfo::recalc () {
   width  = maxX - minX;
   height = maxY - minY;
   grid.push_back(vector<triplet>());
+  heightsChanged();
 }
 
 void ZoneGraphicsInfo::gridAdd (triplet coords) {
@@ -632,6 +637,107 @@ void ZoneGraphicsInfo::calcGrid () {
       (*i).clear();
       (*i) = result;
     }
+    (*zone)->heightsChanged();
+  }
+}
+
+// Grid lines from 'from' to 'to' in jumps of 'step', always ending on 'to'
+// so that neighbouring tiles meet.
+static void lodLines (int from, int to, int step, vector<int>& ret) {
+  ret.clear();
+  for (int i = from; i < to; i += step) ret.push_back(i);
+  ret.push_back(to);
+}
+
+void ZoneGraphicsInfo::fillMesh (vector<float>& vertices, vector<unsigned int>& indices, vector<TerrainTile>& tiles) const {
+  static const double step = 1.0 / zoneSize;
+  vertices.clear();
+  vertices.reserve(zoneSize * zoneSize * 5);
+  double maxStep = 0;
+  for (int x = 0; x < zoneSize; ++x) {
+    for (int y = 0; y < zoneSize; ++y) {
+      vertices.push_back(minX + x * step * width);
+      vertices.push_back(minY + y * step * height);
+      vertices.push_back(heightMap.at(x, y));
+      vertices.push_back(x * step);
+      vertices.push_back(y * step);
+      if (x > 0) maxStep = max(maxStep, (double) fabs(heightMap.at(x, y) - heightMap.at(x-1, y)));
+      if (y > 0) maxStep = max(maxStep, (double) fabs(heightMap.at(x, y) - heightMap.at(x, y-1)));
+    }
+  }
+
+  // A coarse edge can cut a neighbour's finer edge by at most this much.
+  // Positive z is downwards.
+  double skirtDepth = maxStep * (1 << (numLods - 1));
+  vector<int> skirtPoints(zoneSize * zoneSize, -1);
+  unsigned int numPoints = zoneSize * zoneSize;
+
+  indices.clear();
+  tiles.clear();
+  vector<int> xs;
+  vector<int> ys;
+  for (int x0 = 0; x0 < zoneSize - 1; x0 += tileCells) {
+    int x1 = min(x0 + tileCells, zoneSize - 1);
+    for (int y0 = 0; y0 < zoneSize - 1; y0 += tileCells) {
+      int y1 = min(y0 + tileCells, zoneSize - 1);
+      TerrainTile tile;
+      tile.low  = triplet(minX + x0 * step * width, minY + y0 * step * height, heightMap.at(x0, y0));
+      tile.high = triplet(minX + x1 * step * width, minY + y1 * step * height, heightMap.at(x0, y0));
+      for (int x = x0; x <= x1; ++x) {
+	for (int y = y0; y <= y1; ++y) {
+	  tile.low.z()  = min(tile.low.z(),  (double) heightMap.at(x, y));
+	  tile.high.z() = max(tile.high.z(), (double) heightMap.at(x, y));
+	}
+      }
+      tile.high.z() += skirtDepth;
+
+      for (int lod = 0; lod < numLods; ++lod) {
+	tile.firstIndex[lod] = indices.size();
+	lodLines(x0, x1, 1 << lod, xs);
+	lodLines(y0, y1, 1 << lod, ys);
+	// Two triangles per cell, same winding as the full-detail grid.
+	for (unsigned int i = 1; i < xs.size(); ++i) {
+	  for (unsigned int j = 1; j < ys.size(); ++j) {
+	    unsigned int nw = xs[i-1] * zoneSize + ys[j-1];
+	    unsigned int sw = xs[i-1] * zoneSize + ys[j];
+	    unsigned int ne = xs[i]   * zoneSize + ys[j-1];
+	    unsigned int se = xs[i]   * zoneSize + ys[j];
+	    indices.push_back(nw);
+	    indices.push_back(sw);
+	    indices.push_back(ne);
+	    indices.push_back(sw);
+	    indices.push_back(se);
+	    indices.push_back(ne);
+	  }
+	}
+
+	// Skirts along the four edges: the edge points, in order.
+	for (int edge = 0; edge < 4; ++edge) {
+	  vector<unsigned int> rim;
+	  if (edge < 2) for (unsigned int j = 0; j < ys.size(); ++j) rim.push_back((0 == edge ? x0 : x1) * zoneSize + ys[j]);
+	  else          for (unsigned int i = 0; i < xs.size(); ++i) rim.push_back(xs[i] * zoneSize + (2 == edge ? y0 : y1));
+	  for (unsigned int r = 0; r < rim.size(); ++r) {
+	    if (0 <= skirtPoints[rim[r]]) continue;
+	    skirtPoints[rim[r]] = numPoints++;
+	    for (int k = 0; k < 5; ++k) {
+	      float value = vertices[rim[r]*5 + k];
+	      vertices.push_back(value);
+	    }
+	    vertices[skirtPoints[rim[r]]*5 + 2] += skirtDepth;
+	  }
+	  for (unsigned int r = 1; r < rim.size(); ++r) {
+	    indices.push_back(rim[r-1]);
+	    indices.push_back(rim[r]);
+	    indices.push_back(skirtPoints[rim[r]]);
+	    indices.push_back(rim[r-1]);
+	    indices.push_back(skirtPoints[rim[r]]);
+	    indices.push_back(skirtPoints[rim[r-1]]);
+	  }
+	}
+	tile.numIndices[lod] = indices.size() - tile.firstIndex[lod];
+      }
+      tiles.push_back(tile);
+    }
   }
 }
 
@@ -641,9 +747,6 @@ double ZoneGraphicsInfo::calcHeight (double x, double y) {
   y -= minY;
   x /= width;
   y /= height;
-  x *= GraphicsInfo::zoneSize;
-  y *= GraphicsInfo::zoneSize;
-  int xval = min((int) floor(x), GraphicsInfo::zoneSize-1); // Deal with roundoff error at edges.
-  int yval = min((int) floor(y), GraphicsInfo::zoneSize-1);
-  return heightMap[xval][yval];
+  // Bilinear, matching the terrain mesh between heightmap points.
+  return heightMap.sample(x, y);
 }
@@ -102,8 +102,26 @@ public:
   void addHex (HexGraphicsInfo* hex);
   void addLine (LineGraphicsInfo* lin);
   void addVertex (VertexGraphicsInfo* vex);
-  double getHeight (unsigned int x, unsigned int y) {return heightMap[x][y];}
+  double getHeight (unsigned int x, unsigned int y) {return heightMap.at(x, y);}
   double calcHeight (double x, double y);
+  static const int tileCells = 64; // Heightmap cells along each side of a terrain tile.
+  static const int numLods = 4;    // Detail levels per tile; each skips twice as many cells as the last.
+
+  // Square piece of the terrain mesh with its own bounds, drawable at any
+  // detail level from its own range of indices.
+  struct TerrainTile {
+    triplet low;
+    triplet high;
+    unsigned int firstIndex[numLods];
+    unsigned int numIndices[numLods];
+  };
+
+  double cellSize () const {return max(width, height) / zoneSize;}
+  // Interleaved x, y, z, s, t per heightmap point, plus skirt points hanging
+  // below tile edges to hide cracks between neighbouring detail levels.
+  void fillMesh (vector<float>& vertices, vector<unsigned int>& indices, vector<TerrainTile>& tiles) const;
+  unsigned int getMeshVersion () const {return meshVersion;}
+  void heightsChanged () {meshVersion = ++meshVersions;}
   static void calcGrid (); 
 
   gridIt gridBegin () {return grid.begin();}
@@ -114,8 +132,11 @@ private:
   void gridAdd (triplet coords);  
   void recalc ();
 
-  double** heightMap; 
+  HeightGrid heightMap; // Detailed heights, zoneSize on a side.
   vector<vector<triplet> > grid; // Stores points to draw hex grid on terrain. 
+  unsigned int meshVersion;      // Changes with heights or extent, so drawers know to rebuild their mesh.
+
+  static unsigned int meshVersions; // Shared, so a zone from a new game never reuses an old version.
 };
 
 #endif
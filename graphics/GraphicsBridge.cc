@@ -1,6 +1,6 @@
 #include "GraphicsBridge.hh"
 
-double* GraphicsInfo::heightMap = 0;
+HeightGrid GraphicsInfo::heightMap;
 map<const TextInfo*, vector<DisplayEvent> > TextInfo::recentEvents;
 map<const TextInfo*, vector<DisplayEvent> > TextInfo::savingEvents;
 bool TextInfo::accumulate = true;
@@ -18,9 +18,10 @@ GraphicsInfo::~GraphicsInfo () {}
 TextBridge::~TextBridge () {}
 
 int GraphicsInfo::zoneSide = 4;
+std::atomic<unsigned int> GraphicsInfo::sceneVersion(1);
 
 int GraphicsInfo::getHeight (int x, int y) {
-  return heightMap ? heightMap[y*(2 + 3*zoneSide) + x] : 0;
+  return heightMap.empty() ? 0 : heightMap.at(x, y);
 }
 
 void GraphicsInfo::getHeightMapCoords (int& hexX, int& hexY, Vertices dir) {
@@ -55,7 +56,13 @@ void GraphicsInfo::getHeightMapCoords (int& hexX, int& hexY, Vertices dir) {
   hexY = realY;
 }
 
-GraphicsInfo::GraphicsInfo () {}
+GraphicsInfo::GraphicsInfo ()
+  : radius(0)
+{}
+
+void GraphicsInfo::includeInBounds (const triplet& point) {
+  radius = max(radius, (point - position).norm());
+}
 
 TextInfo::~TextInfo () {}
 
@@ -1,8 +1,10 @@
 #ifndef GRAPHICSBRIDGE_HH
 #define GRAPHICSBRIDGE_HH
 
+#include <atomic>
 #include <type_traits>
 
+#include "HeightGrid.hh"
 #include "ThreeDSprite.hh"
 #include "UtilityFunctions.hh"
 #include "Directions.hh"
@@ -93,19 +95,30 @@ public:
 
   triplet getNormal () const {return normal;}
   triplet getPosition () const {return position;}
+  double getRadius () const {return radius;} // Flat outline around position; sprites stand above it.
   int getZone () const {return 0;}
 
   static pair<double, double> getTexCoords (triplet gameCoords, int zone);
   static int getHeight (int x, int y);
   static void getHeightMapCoords (int& hexX, int& hexY, Vertices dir);
 
+  // Bumped whenever something drawn from the game state changes, so the
+  // renderer knows its retained scene is out of date. Atomic because the
+  // computer players move on their own thread.
+  static void sceneChanged () {++sceneVersion;}
+  static unsigned int getSceneVersion () {return sceneVersion;}
+
   static const int zoneSize = 512; // Size in pixels (for internal purposes, not on the screen).
 
 protected:
+  void includeInBounds (const triplet& point);
+
   triplet position;
   triplet normal;
+  double radius;
   static int zoneSide; // Size in hexes
-  static double* heightMap;
+  static std::atomic<unsigned int> sceneVersion;
+  static HeightGrid heightMap;
 
   static const double xIncrement;
   static const double yIncrement;
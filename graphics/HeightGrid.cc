@@ -0,0 +1,57 @@
+#include "HeightGrid.hh"
+#include <algorithm>
+#include <cmath>
+#include <stdint.h>
+
+HeightGrid::HeightGrid ()
+  : columns(0)
+  , rows(0)
+  , stride(0)
+  , offset(0)
+{}
+
+HeightGrid::HeightGrid (int c, int r)
+  : columns(0)
+  , rows(0)
+  , stride(0)
+  , offset(0)
+{
+  resize(c, r);
+}
+
+void HeightGrid::resize (int c, int r) {
+  static const int floatsPerAlignment = rowAlignment / sizeof(float);
+  columns = c;
+  rows = r;
+  stride = ((columns + floatsPerAlignment - 1) / floatsPerAlignment) * floatsPerAlignment;
+  // Room to slide the first cell up to the next boundary.
+  storage.assign(stride * rows + floatsPerAlignment, 0);
+  uintptr_t misalignment = ((uintptr_t) &storage[0]) % rowAlignment;
+  offset = (misalignment ? (rowAlignment - misalignment) / sizeof(float) : 0);
+}
+
+double HeightGrid::sample (double xfrac, double yfrac) const {
+  double x = xfrac * columns;
+  double y = yfrac * rows;
+  int xbin = max(0, min((int) floor(x), columns - 1));
+  int ybin = max(0, min((int) floor(y), rows - 1));
+  int nextXbin = min(xbin + 1, columns - 1);
+  int nextYbin = min(ybin + 1, rows - 1);
+  x = max(0.0, min(x - xbin, 1.0));
+  y = max(0.0, min(y - ybin, 1.0));
+
+  const float* row1 = row(ybin);
+  const float* row2 = row(nextYbin);
+  double ret = (1-x)*(1-y) * row1[xbin];
+  ret       +=    x *(1-y) * row1[nextXbin];
+  ret       += (1-x)*   y  * row2[xbin];
+  ret       +=    x *   y  * row2[nextXbin];
+  return ret;
+}
+
+void HeightGrid::scale (float factor) {
+  for (int y = 0; y < rows; ++y) {
+    float* cells = row(y);
+    for (int x = 0; x < columns; ++x) cells[x] *= factor;
+  }
+}
@@ -0,0 +1,43 @@
+#ifndef HEIGHTGRID_HH
+#define HEIGHTGRID_HH
+
+#include <vector>
+using namespace std;
+
+// Heights in one contiguous block of floats, row by row (y outer, x
+// inner). Each row starts on a 16-byte boundary, so a row span can be
+// walked by vectorised loops.
+class HeightGrid {
+public:
+  HeightGrid ();
+  HeightGrid (int columns, int rows);
+
+  void resize (int columns, int rows); // Discards old contents; new grid is all zero.
+  int getColumns () const {return columns;}
+  int getRows () const {return rows;}
+  bool empty () const {return 0 == columns * rows;}
+
+  float& at (int x, int y) {return storage[offset + y*stride + x];}
+  float  at (int x, int y) const {return storage[offset + y*stride + x];}
+  float*       row (int y) {return &storage[offset + y*stride];}
+  const float* row (int y) const {return &storage[offset + y*stride];}
+
+  // Bilinear between the four cells around (xfrac*columns, yfrac*rows),
+  // fractions being of the whole grid; clamped at the edges.
+  double sample (double xfrac, double yfrac) const;
+  void scale (float factor);
+
+private:
+  HeightGrid (const HeightGrid& other);            // Copies would lose the alignment;
+  HeightGrid& operator= (const HeightGrid& other); // not implemented.
+
+  static const int rowAlignment = 16;
+
+  int columns;
+  int rows;
+  int stride;          // Floats from one row to the next, a multiple of rowAlignment bytes.
+  unsigned int offset; // Floats from start of storage to first aligned cell.
+  vector<float> storage;
+};
+
+#endif
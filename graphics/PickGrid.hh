@@ -0,0 +1,99 @@
+#ifndef PICKGRID_HH
+#define PICKGRID_HH
+
+#include <vector>
+#include <cmath>
+#include "UtilityFunctions.hh"
+using namespace std;
+
+// Uniform grid over the map-plane outlines of one kind of graphics
+// object, so that finding the object under the mouse tests only the few
+// listed in one cell. Each object is listed in every cell its bounding
+// circle touches, in iteration order, so find returns what a linear
+// search over Iterable<T> would.
+template <class T> class PickGrid {
+public:
+  PickGrid () : minX(0), minY(0), cellSize(1), columns(0), rows(0) {}
+
+  void build () {
+    cellStarts.clear();
+    entries.clear();
+    columns = 0;
+    rows = 0;
+    if (Iterable<T>::start() == Iterable<T>::final()) return;
+
+    triplet first = (*Iterable<T>::start())->getPosition();
+    minX = first.x();
+    minY = first.y();
+    double maxX = minX;
+    double maxY = minY;
+    double totalRadius = 0;
+    for (typename Iterable<T>::Iter dat = Iterable<T>::start(); dat != Iterable<T>::final(); ++dat) {
+      triplet pos = (*dat)->getPosition();
+      double radius = (*dat)->getRadius();
+      minX = min(minX, pos.x() - radius);
+      minY = min(minY, pos.y() - radius);
+      maxX = max(maxX, pos.x() + radius);
+      maxY = max(maxY, pos.y() + radius);
+      totalRadius += radius;
+    }
+
+    // Cells about one object across keep each list to a handful.
+    cellSize = 2 * totalRadius / Iterable<T>::totalAmount();
+    if (cellSize <= 0) cellSize = 1;
+    columns = 1 + (int) floor((maxX - minX) / cellSize);
+    rows = 1 + (int) floor((maxY - minY) / cellSize);
+
+    // Count, then fill, so that each cell's list is contiguous.
+    cellStarts.assign(columns * rows + 1, 0);
+    int lowCol, lowRow, highCol, highRow;
+    for (typename Iterable<T>::Iter dat = Iterable<T>::start(); dat != Iterable<T>::final(); ++dat) {
+      cellRange(*dat, lowCol, lowRow, highCol, highRow);
+      for (int row = lowRow; row <= highRow; ++row) {
+	for (int col = lowCol; col <= highCol; ++col) cellStarts[row * columns + col + 1]++;
+      }
+    }
+    for (unsigned int i = 1; i < cellStarts.size(); ++i) cellStarts[i] += cellStarts[i-1];
+
+    entries.resize(cellStarts.back());
+    vector<unsigned int> filled(cellStarts.begin(), cellStarts.end() - 1);
+    for (typename Iterable<T>::Iter dat = Iterable<T>::start(); dat != Iterable<T>::final(); ++dat) {
+      cellRange(*dat, lowCol, lowRow, highCol, highRow);
+      for (int row = lowRow; row <= highRow; ++row) {
+	for (int col = lowCol; col <= highCol; ++col) entries[filled[row * columns + col]++] = *dat;
+      }
+    }
+  }
+
+  T* find (double x, double y) const {
+    if (0 == columns) return 0;
+    int col = (int) floor((x - minX) / cellSize);
+    int row = (int) floor((y - minY) / cellSize);
+    if ((col < 0) || (col >= columns) || (row < 0) || (row >= rows)) return 0;
+    int cell = row * columns + col;
+    for (unsigned int i = cellStarts[cell]; i < cellStarts[cell + 1]; ++i) {
+      if (entries[i]->isInside(x, y)) return entries[i];
+    }
+    return 0;
+  }
+
+private:
+  void cellRange (const T* dat, int& lowCol, int& lowRow, int& highCol, int& highRow) const {
+    triplet pos = dat->getPosition();
+    double radius = dat->getRadius();
+    lowCol  = max(0,           (int) floor((pos.x() - radius - minX) / cellSize));
+    lowRow  = max(0,           (int) floor((pos.y() - radius - minY) / cellSize));
+    highCol = min(columns - 1, (int) floor((pos.x() + radius - minX) / cellSize));
+    highRow = min(rows - 1,    (int) floor((pos.y() + radius - minY) / cellSize));
+  }
+
+  double minX;
+  double minY;
+  double cellSize;
+  int columns;
+  int rows;
+  vector<unsigned int> cellStarts; // Cell i lists entries[cellStarts[i]] up to entries[cellStarts[i+1]].
+  vector<T*> entries;
+};
+
+#endif
@@ -0,0 +1,5 @@
+#include "RenderStats.hh"
+
+unsigned int RenderStats::drawCalls = 0;
+unsigned int RenderStats::textureBinds = 0;
+unsigned int RenderStats::vertices = 0;
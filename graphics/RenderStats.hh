@@ -0,0 +1,15 @@
+#ifndef RENDERSTATS_HH
+#define RENDERSTATS_HH
+
+// What the drawing code has handed to GL since the last reset, for the
+// render benchmark. GL keeps no tally of its own, so the draw and bind
+// sites count themselves.
+struct RenderStats {
+  static void reset () {drawCalls = 0; textureBinds = 0; vertices = 0;}
+
+  static unsigned int drawCalls;    // glBegin, glDrawArrays and glDrawElements.
+  static unsigned int textureBinds;
+  static unsigned int vertices;
+};
+
+#endif
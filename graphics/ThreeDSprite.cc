@@ -1,10 +1,17 @@
 #include "ThreeDSprite.hh"
 #include "boost/tokenizer.hpp"
+#include <algorithm>
+#include <cstring>
 #include <QtOpenGL>
+#include <QDir>
+#include <QFile>
 #include "Logger.hh" 
+#include "RenderStats.hh"
+#include "glextensions.h"
 
 map<string, GLuint> ThreeDSprite::textureIndices; 
 ThreeDSprite::Material* ThreeDSprite::defaultMaterial = new Material(); 
+vector<ThreeDSprite*> ThreeDSprite::queued;
 
 ThreeDSprite::Vertex::Vertex () : x(0), y(0), z(0) {}
 ThreeDSprite::Index::Index () : vertex(-1), texture(-1), normal(-1) {}
@@ -15,66 +22,212 @@ ThreeDSprite::ThreeDSprite (string fname, vector<string> specials)
   : numSpecials(0)
   , scaleFactor(1.0, 1.0, 1.0)
 {
-  loadFile(fname);
+  if (!readCache(fname)) {
+    loadFile(fname);
+    writeCache(fname);
+  }
   assert(0 < groups.size()); 
   
   int counter = 1;
   for (vector<string>::iterator spec = specials.begin(); spec != specials.end(); ++spec) {
-    assert (0 < groups[*spec].faces.size());
+    assert (0 < groups[*spec].corners.size());
     groups[*spec].special = counter++;
   }
 
-  listIndex = glGenLists(1+specials.size());
-  assert(0 != listIndex); 
-  glNewList(listIndex, GL_COMPILE); 
+  // Ordinary groups first, then specials in order, as the display lists were.
   for (map<string, Group>::iterator g = groups.begin(); g != groups.end(); ++g) {
     if (0 != (*g).second.special) continue;
-    glColor3d((*g).second.material->colour.x(), (*g).second.material->colour.y(), (*g).second.material->colour.z()); 
-    glBindTexture(GL_TEXTURE_2D, (*g).second.material->textureIndex);
-    for (vector<Face*>::iterator face = (*g).second.faces.begin(); face != (*g).second.faces.end(); ++face) {
-      drawFace(*face);
-    }
+    Mesh mesh;
+    mesh.material = (*g).second.material;
+    mesh.special = 0;
+    mesh.corners.swap((*g).second.corners);
+    meshes.push_back(mesh);
   }
-  glEndList();
 
-  for (map<string, Group>::iterator g = groups.begin(); g != groups.end(); ++g) {
-    if (0 == (*g).second.special) continue;
-    glNewList(listIndex+(*g).second.special, GL_COMPILE);
-    glColor3d(1.0, 1.0, 1.0); 
-    for (vector<Face*>::iterator face = (*g).second.faces.begin(); face != (*g).second.faces.end(); ++face) {
-      drawFace(*face);
+  for (int spec = 1; spec < counter; ++spec) {
+    for (map<string, Group>::iterator g = groups.begin(); g != groups.end(); ++g) {
+      if (spec != (*g).second.special) continue;
+      Mesh mesh;
+      mesh.material = (*g).second.material;
+      mesh.special = spec;
+      mesh.corners.swap((*g).second.corners);
+      meshes.push_back(mesh);
+      numSpecials++; 
     }
-    glEndList();
-    numSpecials++; 
   }
 }
 
+void ThreeDSprite::addFace (const vector<Index>& face, Group& group) {
+  assert((3 == face.size()) || (4 == face.size()));
+  // Quads become two triangles sharing the first corner.
+  static const int triangles[6] = {0, 1, 2, 0, 2, 3};
+  int numCorners = (3 == face.size() ? 3 : 6);
+  for (int i = 0; i < numCorners; ++i) {
+    const Index& ind = face[triangles[i]];
+    const Vertex& pos = vertices[ind.vertex];
+    group.corners.push_back(pos.x);
+    group.corners.push_back(pos.y);
+    group.corners.push_back(pos.z);
+    group.corners.push_back(-1 != ind.texture ? textures[ind.texture].x : 0);
+    group.corners.push_back(-1 != ind.texture ? textures[ind.texture].y : 0);
+  }
+}
+
+void ThreeDSprite::drawCorners (const GLfloat* corners, unsigned int numCorners) {
+  if (0 == numCorners) return;
+  static const GLsizei stride = 5 * sizeof(GLfloat);
+  glVertexPointer(3, GL_FLOAT, stride, corners);
+  glTexCoordPointer(2, GL_FLOAT, stride, corners + 3);
+  glDrawArrays(GL_TRIANGLES, 0, numCorners);
+  RenderStats::drawCalls++;
+  RenderStats::vertices += numCorners;
+}
+
 void ThreeDSprite::draw (vector<int>& textures) {
+  glPushMatrix();
   glScaled(scaleFactor.x(), scaleFactor.y(), scaleFactor.z()); 
-  glCallList(listIndex);
-  for (int i = 0; i < numSpecials; ++i) {
-    if (i >= (int) textures.size()) break; 
-    if (-1 == textures[i]) continue;
-    glBindTexture(GL_TEXTURE_2D, textures[i]); 
-    glCallList(listIndex+i+1); 
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+  for (vector<Mesh>::iterator mesh = meshes.begin(); mesh != meshes.end(); ++mesh) {
+    if (0 == (*mesh).special) {
+      glColor3d((*mesh).material->colour.x(), (*mesh).material->colour.y(), (*mesh).material->colour.z()); 
+      glBindTexture(GL_TEXTURE_2D, (*mesh).material->textureIndex);
+      RenderStats::textureBinds++;
+    }
+    else {
+      if ((*mesh).special > (int) textures.size()) break; 
+      if (-1 == textures[(*mesh).special - 1]) continue;
+      glColor3d(1.0, 1.0, 1.0); 
+      glBindTexture(GL_TEXTURE_2D, textures[(*mesh).special - 1]); 
+      RenderStats::textureBinds++;
+    }
+    drawCorners((*mesh).corners.empty() ? 0 : &(*mesh).corners[0], (*mesh).corners.size() / 5);
+  }
+  glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+  glPopMatrix();
+}
+
+void ThreeDSprite::addInstance (const triplet& position, double angle, int flag) {
+  if (instances.empty()) queued.push_back(this);
+  Instance inst;
+  inst.x = position.x();
+  inst.y = position.y();
+  inst.z = position.z();
+  inst.cosAngle = cos(degToRad(angle));
+  inst.sinAngle = sin(degToRad(angle));
+  inst.flag = flag;
+  instances.push_back(inst);
+}
+
+void ThreeDSprite::takeInstances (BatchList& ret) {
+  for (vector<ThreeDSprite*>::iterator sprite = queued.begin(); sprite != queued.end(); ++sprite) {
+    (*sprite)->batchQueued(ret);
+  }
+  queued.clear();
+}
+
+void ThreeDSprite::takeOwnInstances (BatchList& ret) {
+  if (instances.empty()) return;
+  queued.erase(find(queued.begin(), queued.end(), this));
+  batchQueued(ret);
+}
+
+void ThreeDSprite::drawBatches (const BatchList& batches) {
+  if (batches.empty()) return;
+  glMatrixMode(GL_MODELVIEW);
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+  bool boundBuffer = false;
+  for (BatchList::const_iterator batch = batches.begin(); batch != batches.end(); ++batch) {
+    glColor3d((*batch).colour.x(), (*batch).colour.y(), (*batch).colour.z());
+    glBindTexture(GL_TEXTURE_2D, (*batch).texture);
+    RenderStats::textureBinds++;
+    if ((*batch).buffer) {
+      glBindBuffer(GL_ARRAY_BUFFER, (*batch).buffer);
+      boundBuffer = true;
+      drawCorners(0, (*batch).numCorners);
+    }
+    else {
+      if (boundBuffer) glBindBuffer(GL_ARRAY_BUFFER, 0);
+      boundBuffer = false;
+      drawCorners((*batch).corners.empty() ? 0 : &(*batch).corners[0], (*batch).corners.size() / 5);
+    }
   }
+  if (boundBuffer) glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
 }
 
-void ThreeDSprite::drawFace (Face* face) {
-  switch (face->verts.size()) {
-  case 3 : glBegin(GL_TRIANGLES); break;
-  case 4 : glBegin(GL_QUADS);     break;
-  default:
-    assert(false);
-    break;
+void ThreeDSprite::uploadBatches (BatchList& batches) {
+  if (!getGLExtensionFunctions().openGL15Supported()) return;
+  for (BatchList::iterator batch = batches.begin(); batch != batches.end(); ++batch) {
+    if (((*batch).buffer) || ((*batch).corners.empty())) continue;
+    glGenBuffers(1, &(*batch).buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, (*batch).buffer);
+    glBufferData(GL_ARRAY_BUFFER, (*batch).corners.size() * sizeof(GLfloat), &(*batch).corners[0], GL_STATIC_DRAW);
+    (*batch).numCorners = (*batch).corners.size() / 5;
+    vector<GLfloat>().swap((*batch).corners);
   }
-  for (vector<Index>::iterator ind = face->verts.begin(); ind != face->verts.end(); ++ind) {
-    int tex = (*ind).texture;
-    if (-1 != tex) glTexCoord2d(textures[tex].x, textures[tex].y);
-    tex = (*ind).vertex;
-    glVertex3d(vertices[tex].x, vertices[tex].y, vertices[tex].z);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void ThreeDSprite::releaseBatches (BatchList& batches) {
+  for (BatchList::iterator batch = batches.begin(); batch != batches.end(); ++batch) {
+    if (!(*batch).buffer) continue;
+    glDeleteBuffers(1, &(*batch).buffer);
+    (*batch).buffer = 0;
+    (*batch).numCorners = 0;
+  }
+}
+
+void ThreeDSprite::batchQueued (BatchList& ret) {
+  // Fixed-function GL has no instanced arrays, so each batch is the mesh
+  // copied once per instance with the instance transform applied here;
+  // one draw call per mesh and flag instead of one per copy.
+  if (0 < numSpecials) stable_sort(instances.begin(), instances.end());
+  for (vector<Mesh>::iterator mesh = meshes.begin(); mesh != meshes.end(); ++mesh) {
+    unsigned int meshCorners = (*mesh).corners.size() / 5;
+    if (0 == meshCorners) continue;
+    vector<Instance>::iterator first = instances.begin();
+    while (first != instances.end()) {
+      vector<Instance>::iterator last = first;
+      if (0 == (*mesh).special) last = instances.end();
+      else while ((last != instances.end()) && ((*last).flag == (*first).flag)) ++last;
+
+      if ((0 != (*mesh).special) && (-1 == (*first).flag)) {
+	first = last;
+	continue;
+      }
+      ret.push_back(Batch());
+      Batch& batch = ret.back();
+      if (0 == (*mesh).special) {
+	batch.colour = (*mesh).material->colour;
+	batch.texture = (*mesh).material->textureIndex;
+      }
+      else {
+	batch.colour = triplet(1.0, 1.0, 1.0);
+	batch.texture = (*first).flag;
+      }
+
+      batch.corners.resize((last - first) * meshCorners * 5);
+      GLfloat* out = &batch.corners[0];
+      for (vector<Instance>::iterator inst = first; inst != last; ++inst) {
+	const GLfloat* in = &(*mesh).corners[0];
+	for (unsigned int c = 0; c < meshCorners; ++c, in += 5, out += 5) {
+	  GLfloat x = in[0] * scaleFactor.x();
+	  GLfloat y = in[1] * scaleFactor.y();
+	  out[0] = (*inst).x + (*inst).cosAngle * x - (*inst).sinAngle * y;
+	  out[1] = (*inst).y + (*inst).sinAngle * x + (*inst).cosAngle * y;
+	  out[2] = (*inst).z + in[2] * scaleFactor.z();
+	  out[3] = in[3];
+	  out[4] = in[4];
+	}
+      }
+      first = last;
+    }
   }
-  glEnd(); 
+  instances.clear();
 }
 
 void ThreeDSprite::loadMaterials (string fname) {
@@ -108,6 +261,7 @@ void ThreeDSprite::loadMaterials (string fname) {
     // Well, and textures.
     else if (token == "map_Kd") {
       reader >> token;
+      materials[matname]->textureName = token;
       materials[matname]->textureIndex = getTextureIndex(token); 
     }
     getline(reader, token); // Ignore everything else.     
@@ -116,6 +270,7 @@ void ThreeDSprite::loadMaterials (string fname) {
 }
 
 void ThreeDSprite::loadFile (string fname) {
+  sourceFiles.push_back(fname);
   ifstream reader;
   reader.open(fname.c_str());
   string token;
@@ -133,6 +288,7 @@ void ThreeDSprite::loadFile (string fname) {
     }
     if (token == "mtllib") {
       reader >> token; // Filename
+      sourceFiles.push_back(gfx+token);
       loadMaterials(gfx+token);      
     }
     if (token == "v") {
@@ -174,6 +330,11 @@ void ThreeDSprite::loadFile (string fname) {
     }
   }
   reader.close(); 
+
+  // Only needed while reading faces.
+  vector<Vertex>().swap(vertices);
+  vector<Vertex>().swap(textures);
+  vector<Vertex>().swap(normals);
 }
 
 GLuint ThreeDSprite::getTextureIndex (string fname) {
@@ -196,7 +357,7 @@ void ThreeDSprite::makeFace (ifstream& reader, string groupName) {
   boost::char_separator<char> space(" ");
   boost::char_separator<char> slash("/", "", boost::keep_empty_tokens);
   boost::tokenizer<boost::char_separator<char> > vertices(line, space);
-  Face* nface = new Face(); 
+  vector<Index> face;
   for (boost::tokenizer<boost::char_separator<char> >::iterator vtx = vertices.begin(); vtx != vertices.end(); ++vtx) {
     Index curr;
     boost::tokenizer<boost::char_separator<char> > nums(*vtx, slash);
@@ -209,10 +370,188 @@ void ThreeDSprite::makeFace (ifstream& reader, string groupName) {
     curr.normal = atoi((*n).c_str()) - 1;
 
   doneWithIndex:
-    nface->verts.push_back(curr); 
+    face.push_back(curr); 
+  }
+
+  addFace(face, groups[groupName]);
+}
+
+
+
+// Flattened groups of a parsed .obj, so later runs map the file instead
+// of tokenising text. Layout, native byte order, strings as uint32
+// length and bytes:
+//   'C' 'S' 'P' 'R', uint32 version,
+//   uint32 count, then per source file: string path, int64 size, int64 modified,
+//   uint32 count, then per material: string name, 3 doubles colour, string texture,
+//   uint32 count, then per group: string name, string material, uint32 floats, floats.
+static const char spriteCacheMagic[4] = {'C', 'S', 'P', 'R'};
+static const unsigned int spriteCacheVersion = 1;
+
+static string spriteCacheName (const string& fname) {
+  // FNV-1a of the path, since sprite paths contain separators.
+  unsigned long long hash = 14695981039346656037ULL;
+  for (unsigned int i = 0; i < fname.size(); ++i) {
+    hash ^= (unsigned char) fname[i];
+    hash *= 1099511628211ULL;
+  }
+  sprintf(strbuffer, "./cache/sprite_%016llx.bin", hash);
+  return strbuffer;
+}
+
+// Reads from the mapped file, failing rather than running off its end.
+class SpriteCacheReader {
+public:
+  SpriteCacheReader (const uchar* d, qint64 s) : dat(d), size(s), pos(0), ok(true) {}
+  bool good () const {return ok;}
+  qint64 remaining () const {return size - pos;}
+  void read (void* out, qint64 bytes) {
+    if ((!ok) || (bytes > size - pos)) {
+      ok = false;
+      return;
+    }
+    memcpy(out, dat + pos, bytes);
+    pos += bytes;
+  }
+  template <class T> T get () {
+    T ret = T();
+    read(&ret, sizeof(T));
+    return ret;
+  }
+  string getString () {
+    unsigned int length = get<unsigned int>();
+    if ((!ok) || (length > size - pos)) {
+      ok = false;
+      return "";
+    }
+    string ret((const char*) dat + pos, length);
+    pos += length;
+    return ret;
+  }
+
+private:
+  const uchar* dat;
+  qint64 size;
+  qint64 pos;
+  bool ok;
+};
+
+// Deletes whatever it still holds when it goes out of scope, so
+// pointers only survive by being swapped into a longer-lived map.
+template <class T> class OwningMap : public map<string, T*> {
+public:
+  ~OwningMap () {for (typename map<string, T*>::iterator i = this->begin(); i != this->end(); ++i) delete (*i).second;}
+};
+
+template <class T> static void writeRaw (ofstream& out, T dat) {
+  out.write((const char*) &dat, sizeof(T));
+}
+
+static void writeString (ofstream& out, const string& dat) {
+  writeRaw(out, (unsigned int) dat.size());
+  out.write(dat.c_str(), dat.size());
+}
+
+bool ThreeDSprite::readCache (string fname) {
+  QFile file(spriteCacheName(fname).c_str());
+  if (!file.open(QIODevice::ReadOnly)) return false;
+  const uchar* dat = file.map(0, file.size());
+  if (!dat) return false;
+  SpriteCacheReader reader(dat, file.size());
+
+  char magic[4];
+  reader.read(magic, sizeof(magic));
+  if ((!reader.good()) || (!equal(magic, magic + 4, spriteCacheMagic)) || (spriteCacheVersion != reader.get<unsigned int>())) return false;
+
+  // Stale if any source has been touched since the cache was written.
+  unsigned int numSources = reader.get<unsigned int>();
+  for (unsigned int i = 0; (reader.good()) && (i < numSources); ++i) {
+    QFileInfo source(reader.getString().c_str());
+    qint64 size = reader.get<qint64>();
+    qint64 modified = reader.get<qint64>();
+    if ((!source.exists()) || (source.size() != size) || (source.lastModified().toMSecsSinceEpoch() != modified)) return false;
+  }
+
+  OwningMap<Material> cachedMaterials;
+  unsigned int numMaterials = reader.get<unsigned int>();
+  for (unsigned int i = 0; (reader.good()) && (i < numMaterials); ++i) {
+    string name = reader.getString();
+    Material* material = new Material();
+    double colour[3];
+    reader.read(colour, sizeof(colour));
+    material->colour = triplet(colour[0], colour[1], colour[2]);
+    material->textureName = reader.getString();
+    delete cachedMaterials[name];
+    cachedMaterials[name] = material;
   }
 
-  groups[groupName].faces.push_back(nface); 
+  map<string, Group> cachedGroups;
+  unsigned int numGroups = reader.get<unsigned int>();
+  for (unsigned int i = 0; (reader.good()) && (i < numGroups); ++i) {
+    Group& group = cachedGroups[reader.getString()];
+    string material = reader.getString();
+    if (!material.empty()) {
+      if (cachedMaterials.find(material) == cachedMaterials.end()) return false;
+      group.material = cachedMaterials[material];
+    }
+    unsigned int numFloats = reader.get<unsigned int>();
+    if ((!reader.good()) || (0 != numFloats % 5) || (numFloats > reader.remaining() / sizeof(GLfloat))) return false;
+    group.corners.resize(numFloats);
+    if (0 < numFloats) reader.read(&group.corners[0], numFloats * sizeof(GLfloat));
+  }
+
+  if (!reader.good()) {
+    Logger::logStream(Logger::Warning) << "Ignoring truncated sprite cache for " << fname << ".\n";
+    return false;
+  }
+
+  // Textures are only asked for once the whole file has been accepted.
+  for (map<string, Material*>::iterator m = cachedMaterials.begin(); m != cachedMaterials.end(); ++m) {
+    if (!(*m).second->textureName.empty()) (*m).second->textureIndex = getTextureIndex((*m).second->textureName);
+  }
+  materials.swap(cachedMaterials);
+  groups.swap(cachedGroups);
+  return true;
 }
 
+void ThreeDSprite::writeCache (string fname) const {
+  string cacheName = spriteCacheName(fname);
+  QDir().mkpath(QFileInfo(cacheName.c_str()).path());
+  ofstream writer(cacheName.c_str(), ios::out | ios::binary | ios::trunc);
+  if (!writer.good()) {
+    Logger::logStream(Logger::Warning) << "Could not open sprite cache " << cacheName << ", " << fname << " will be parsed again next time.\n";
+    return;
+  }
+
+  writer.write(spriteCacheMagic, sizeof(spriteCacheMagic));
+  writeRaw(writer, spriteCacheVersion);
 
+  writeRaw(writer, (unsigned int) sourceFiles.size());
+  for (vector<string>::const_iterator source = sourceFiles.begin(); source != sourceFiles.end(); ++source) {
+    QFileInfo info((*source).c_str());
+    writeString(writer, *source);
+    writeRaw(writer, (qint64) info.size());
+    writeRaw(writer, (qint64) info.lastModified().toMSecsSinceEpoch());
+  }
+
+  writeRaw(writer, (unsigned int) materials.size());
+  for (map<string, Material*>::const_iterator m = materials.begin(); m != materials.end(); ++m) {
+    writeString(writer, (*m).first);
+    writeRaw(writer, (*m).second->colour.x());
+    writeRaw(writer, (*m).second->colour.y());
+    writeRaw(writer, (*m).second->colour.z());
+    writeString(writer, (*m).second->textureName);
+  }
+
+  writeRaw(writer, (unsigned int) groups.size());
+  for (map<string, Group>::const_iterator g = groups.begin(); g != groups.end(); ++g) {
+    string material;
+    for (map<string, Material*>::const_iterator m = materials.begin(); m != materials.end(); ++m) {
+      if ((*m).second == (*g).second.material) material = (*m).first;
+    }
+    writeString(writer, (*g).first);
+    writeString(writer, material);
+    writeRaw(writer, (unsigned int) (*g).second.corners.size());
+    if (!(*g).second.corners.empty()) writer.write((const char*) &(*g).second.corners[0], (*g).second.corners.size() * sizeof(GLfloat));
+  }
+}
@@ -14,6 +14,31 @@ public:
   ThreeDSprite (string fname, vector<string> specials);
   void draw (vector<int>& textures);
   void setScale (double xsc, double ysc, double zsc) {scaleFactor.x() = xsc; scaleFactor.y() = ysc; scaleFactor.z() = zsc;}
+
+  // Triangles sharing a texture and colour, five floats per corner as in
+  // Mesh. Kept by the caller, so an unchanged scene is redrawn without
+  // rebuilding it. Once uploaded, the corners live in a vertex buffer.
+  struct Batch {
+    Batch () : texture(0), buffer(0), numCorners(0) {}
+    GLuint texture;
+    triplet colour;
+    vector<GLfloat> corners;
+    GLuint buffer;
+    unsigned int numCorners; // Of the buffer; corners is emptied on upload.
+  };
+  typedef vector<Batch> BatchList;
+
+  // Queues a copy at 'position', turned 'angle' degrees about the z axis,
+  // with 'flag' on the first special group. Queued copies of every sprite
+  // are turned into batches together by takeInstances.
+  void addInstance (const triplet& position, double angle = 0, int flag = -1);
+  void takeOwnInstances (BatchList& ret); // Only this sprite's queued copies.
+  static void takeInstances (BatchList& ret);
+  static void drawBatches (const BatchList& batches);
+  // Moves each batch's corners into a vertex buffer where GL 1.5 is
+  // available; releaseBatches frees them again. Needs a current context.
+  static void uploadBatches (BatchList& batches);
+  static void releaseBatches (BatchList& batches);
   
 private:
   struct Vertex {
@@ -26,39 +51,57 @@ private:
     int texture;
     int normal;
   };
-  struct Face {
-    vector<Index> verts;
-  };
   struct Material {
     Material ();
     triplet colour;
     GLuint textureIndex;
+    string textureName;
   };
+  // Faces are flattened to triangles as they are read, in the Mesh layout.
   struct Group {
     Group (); 
-    vector<Face*> faces;
+    vector<GLfloat> corners;
     int special;
     Material* material; 
   };
+  // A group flattened to triangles, five floats per corner: x, y, z, s, t.
+  struct Mesh {
+    Material* material;
+    int special;
+    vector<GLfloat> corners;
+  };
+  struct Instance {
+    GLfloat x, y, z;
+    GLfloat cosAngle, sinAngle;
+    int flag;
+    bool operator< (const Instance& other) const {return flag < other.flag;}
+  };
   
   vector<Vertex> vertices;
   vector<Vertex> textures;
   vector<Vertex> normals; 
   map<string, Group> groups;
   map<string, Material*> materials; 
-  int listIndex;
+  vector<Mesh> meshes;
+  vector<Instance> instances;
+  vector<string> sourceFiles; // The .obj and its .mtl libraries, for checking the cache.
   int numSpecials; 
   
   void loadFile (string fname);
   void loadMaterials (string fname);  
   void makeFace (ifstream& reader, string groupName);
-  void drawFace (Face* face);
+  void addFace (const vector<Index>& face, Group& group);
+  bool readCache (string fname);
+  void writeCache (string fname) const;
+  void batchQueued (BatchList& ret);
+  static void drawCorners (const GLfloat* corners, unsigned int numCorners);
 
   triplet scaleFactor;
 
   static GLuint getTextureIndex (string fname);
   static map<string, GLuint> textureIndices;
   static Material* defaultMaterial; 
+  static vector<ThreeDSprite*> queued;  // Sprites with instances waiting for takeInstances.
 };
 
 #endif
@@ -61,6 +61,7 @@ void MilUnitGraphicsInfo::updateSprites (MilStrength* dat) {
   // strength is less than M/(N+1), where M is strongest unit's strength
   // and N is number of sprites of strongest unit.
 
+  GraphicsInfo::sceneChanged();
   spriteIndices.clear();
   formation.clear();
   static vector<SortHelper*> forces;